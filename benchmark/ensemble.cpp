@@ -0,0 +1,42 @@
+/**********************
+Benchmark of ensemble mode.
+It simulates the oscillator model "lanes" times one after another, and then
+ simulates all of them together in ensemble mode.
+Usage: bench_ensemble [oscillators] [endtime] [lanes]
+**********************/
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "models.hpp"
+using namespace simucpp;
+using namespace std;
+
+double Run(int n, double endtime, uint lanes, double &result) {
+    Simulator sim(endtime);
+    UOutput *out = new UOutput(&sim);
+    Build_Model(&sim, n, out);
+    sim.Set_EnableStore(false);
+    sim.Set_Ensemble(lanes);
+    sim.Initialize();
+    auto t0 = chrono::steady_clock::now();
+    sim.Simulate();
+    auto t1 = chrono::steady_clock::now();
+    result = out->Get_OutValue();
+    return chrono::duration<double>(t1-t0).count();
+}
+
+int main(int argc, char **argv) {
+    int n = argc>1 ? atoi(argv[1]) : 1000;
+    double endtime = argc>2 ? atof(argv[2]) : 1;
+    uint lanes = argc>3 ? atoi(argv[3]) : 8;
+    double y1, y2, ts = 0;
+    for (uint l=0; l<lanes; ++l)
+        ts += Run(n, endtime, 1, y1);
+    double te = Run(n, endtime, lanes, y2);
+    cout.precision(6);
+    cout << "modules: " << 6*n+3 << "  steps: " << int(endtime/0.001+0.5) << "  lanes: " << lanes << endl;
+    cout << "serial simulations: " << ts << " s  output: " << y1 << endl;
+    cout << "ensemble mode: " << te << " s  output: " << y2 << endl;
+    cout << "speedup: " << ts/te << endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**********************
+Benchmark of linear blocks.
+It simulates a chain of "n" masses connected by springs and dampers, which
+ is built only from SUM, GAIN and INTEGRATOR modules except a nonlinear
+ spring at the end, with and without linear blocks, and prints the time,
+ the amount of merged modules and the difference of outputs.
+Usage: bench_linear [masses] [endtime]
+**********************/
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include "simucpp.hpp"
+using namespace simucpp;
+using namespace std;
+
+// x_i''=k*(x_{i-1}-x_i)+k*(x_{i+1}-x_i)-c*x_i', and the last spring is cubic.
+void Build_Chain(Simulator *sim, int n, UOutput *out) {
+    UInput *in = new UInput(sim);
+    in->Set_Function([](double t){ return sin(t); });
+    vector<UIntegrator*> x(n), v(n);
+    vector<USum*> acc(n);
+    for (int i=0; i<n; ++i) {
+        x[i] = new UIntegrator(sim);
+        v[i] = new UIntegrator(sim);
+        acc[i] = new USum(sim);
+        sim->connectU(v[i], x[i]);
+        sim->connectU(acc[i], v[i]);
+    }
+    for (int i=0; i<n; ++i) {
+        USum *left = new USum(sim);
+        UGain *damp = new UGain(sim);
+        if (i == 0) sim->connectU(in, left);
+        else sim->connectU(x[i-1], left);
+        sim->connectU(x[i], left); left->Set_InputGain(-1);
+        sim->connectU(v[i], damp); damp->Set_Gain(0.2);
+        sim->connectU(left, acc[i]); acc[i]->Set_InputGain(4);
+        if (i+1 < n) {
+            sim->connectU(x[i+1], acc[i]); acc[i]->Set_InputGain(4);
+            sim->connectU(x[i], acc[i]); acc[i]->Set_InputGain(-4);
+        }
+        else {
+            UFcn *cube = new UFcn(sim);
+            cube->Set_Function([](double u){ return -u*u*u; });
+            sim->connectU(x[i], cube);
+            sim->connectU(cube, acc[i]);
+        }
+        sim->connectU(damp, acc[i]); acc[i]->Set_InputGain(-1);
+    }
+    sim->connectU(x[n-1], out);
+}
+
+double Run(int n, double endtime, bool linear, double &result, uint &merged) {
+    Simulator sim(endtime);
+    UOutput *out = new UOutput(&sim);
+    Build_Chain(&sim, n, out);
+    sim.Set_EnableStore(false);
+    sim.Set_EnableLinear(linear);
+    sim.Initialize();
+    auto t0 = chrono::steady_clock::now();
+    sim.Simulate();
+    auto t1 = chrono::steady_clock::now();
+    result = out->Get_OutValue();
+    merged = sim.Get_LinearCount();
+    return chrono::duration<double>(t1-t0).count();
+}
+
+int main(int argc, char **argv) {
+    int n = argc>1 ? atoi(argv[1]) : 20;
+    double endtime = argc>2 ? atof(argv[2]) : 20;
+    double y0, y1;
+    uint merged;
+    double t0 = Run(n, endtime, false, y0, merged);
+    double t1 = Run(n, endtime, true, y1, merged);
+    cout.precision(12);
+    cout << "masses: " << n << "  steps: " << int(endtime/0.001+0.5) << endl;
+    cout << "instruction tape: " << t0 << " s  output: " << y0 << endl;
+    cout << "linear blocks: " << t1 << " s  output: " << y1 << "  merged modules: " << merged << endl;
+    cout.precision(6);
+    cout << "speedup: " << t0/t1 << "  difference: " << fabs(y1-y0) << endl;
+    return 0;
+}
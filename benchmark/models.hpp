@@ -0,0 +1,39 @@
+/**********************
+Models shared by benchmark programs.
+**********************/
+#ifndef BENCHMARK_MODELS_H
+#define BENCHMARK_MODELS_H
+#include "simucpp.hpp"
+using namespace simucpp;
+
+// Every oscillator has 6 unit modules:
+//  x1'=x2, x2'=u-0.5*x2-x1-0.1*x1^3
+inline void Build_Model(Simulator *sim, int n, UOutput *out) {
+    UInput *in = new UInput(sim);
+    in->Set_Function([](double t){ return t<1 ? 1.0 : 0.0; });
+    USum *total = new USum(sim);
+    for (int i=0; i<n; ++i) {
+        UIntegrator *x1 = new UIntegrator(sim);
+        UIntegrator *x2 = new UIntegrator(sim);
+        USum *sum = new USum(sim);
+        UGain *damp = new UGain(sim);
+        UFcn *square = new UFcn(sim);
+        UProduct *prod = new UProduct(sim);
+        sim->connectU(x1, square);
+        square->Set_Function([](double u){ return u*u; });
+        sim->connectU(square, prod);
+        sim->connectU(x1, prod);
+        sim->connectU(x2, damp);
+        damp->Set_Gain(0.5);
+        sim->connectU(in, sum);
+        sim->connectU(damp, sum); sum->Set_InputGain(-1);
+        sim->connectU(x1, sum); sum->Set_InputGain(-1);
+        sim->connectU(prod, sum); sum->Set_InputGain(-0.1);
+        sim->connectU(sum, x2);
+        sim->connectU(x2, x1);
+        sim->connectU(x1, total);
+    }
+    sim->connectU(total, out);
+}
+
+#endif // BENCHMARK_MODELS_H
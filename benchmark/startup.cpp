@@ -0,0 +1,61 @@
+/**********************
+Benchmark of initialization.
+It builds synthetic models of 10^3 to "maxmodules" unit modules and prints
+ the time of "Initialize()" and of 100 simulation steps. The "oscillators"
+ model is the same as "tape.cpp", and the "mesh" model is a deep graph whose
+ every SUM module reads the two previous ones, so sequence tables share
+ their subgraphs.
+Usage: bench_startup [maxmodules]
+**********************/
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "models.hpp"
+using namespace simucpp;
+using namespace std;
+
+// x(0)=1, x'=-x+s[n-1], s[i]=0.5*s[i-1]+0.5*s[i-2], and s[0]=s[1]=x.
+void Build_Mesh(Simulator *sim, int n, UOutput *out) {
+    UIntegrator *x = new UIntegrator(sim);
+    x->Set_InitialValue(1);
+    USum *s0 = new USum(sim), *s1 = new USum(sim);
+    sim->connectU(x, s0);
+    sim->connectU(x, s1);
+    for (int i=2; i<n; ++i) {
+        USum *s = new USum(sim);
+        sim->connectU(s1, s); s->Set_InputGain(0.5);
+        sim->connectU(s0, s); s->Set_InputGain(0.5);
+        s0 = s1; s1 = s;
+    }
+    USum *dx = new USum(sim);
+    sim->connectU(x, dx); dx->Set_InputGain(-1);
+    sim->connectU(s1, dx);
+    sim->connectU(dx, x);
+    sim->connectU(s1, out);
+}
+
+void Run(int mesh, int modules) {
+    Simulator sim(100*0.001);
+    UOutput *out = new UOutput(&sim);
+    if (mesh) Build_Mesh(&sim, modules, out);
+    else Build_Model(&sim, modules/6, out);
+    sim.Set_EnableStore(false);
+    auto t0 = chrono::steady_clock::now();
+    sim.Initialize();
+    auto t1 = chrono::steady_clock::now();
+    sim.Simulate();
+    auto t2 = chrono::steady_clock::now();
+    cout << (mesh ? "mesh" : "oscillators") << "  modules: " << (mesh ? modules+3 : modules/6*6+3)
+         << "  initialize: " << chrono::duration<double>(t1-t0).count()
+         << " s  100 steps: " << chrono::duration<double>(t2-t1).count()
+         << " s  output: " << out->Get_OutValue() << endl;
+}
+
+int main(int argc, char **argv) {
+    int maxmodules = argc>1 ? atoi(argv[1]) : 1000000;
+    cout.precision(6);
+    for (int mesh=0; mesh<2; ++mesh)
+        for (int modules=1000; modules<=maxmodules; modules*=10)
+            Run(mesh, modules);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**********************
+Benchmark of the compile-time model.
+It simulates a discrete PI controller of a 2-order plant by StaticModel and
+ by Simulator with the tape, prints their time, and checks that their states
+ are identical.
+Usage: bench_static [endtime]
+**********************/
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "simucpp.hpp"
+#include "staticmodel.hpp"
+using namespace simucpp;
+using namespace std;
+
+// x1'=x2, x2'=u-0.5*x2-x1, and u is a PI controller of the sampled x1.
+typedef StaticModel<
+    SConstant,          // 0: reference
+    SIntegrator<2>,     // 1: x1
+    SIntegrator<8>,     // 2: x2
+    SZOH<1>,            // 3: sampled x1
+    SSum<0, 3>,         // 4: error
+    SUnitDelay<6>,      // 5: last accumulated error
+    SSum<5, 4>,         // 6: accumulated error
+    SSum<4, 6>,         // 7: u
+    SSum<7, 2, 1>       // 8: x2'
+> PILoop;
+
+double Run_Static(double endtime, double &x1, double &x2) {
+    PILoop m(endtime);
+    m.Get_Block<0>().Set_OutValue(1);
+    m.Get_Block<3>().Set_SampleTime(0.01);
+    m.Get_Block<4>().Set_InputGain(-1, 1);
+    m.Get_Block<5>().Set_SampleTime(0.01);
+    m.Get_Block<6>().Set_InputGain(0.01, 1);
+    m.Get_Block<7>().Set_InputGain(2, 0);
+    m.Get_Block<7>().Set_InputGain(1, 1);
+    m.Get_Block<8>().Set_InputGain(-0.5, 1);
+    m.Get_Block<8>().Set_InputGain(-1, 2);
+    m.Simulation_Reset();
+    auto t0 = chrono::steady_clock::now();
+    m.Simulate();
+    auto t1 = chrono::steady_clock::now();
+    x1 = m.Get_OutValue<1>();
+    x2 = m.Get_OutValue<2>();
+    return chrono::duration<double>(t1-t0).count();
+}
+
+double Run_Simulator(double endtime, double &x1, double &x2) {
+    Simulator sim(endtime);
+    FUConstant(r, &sim);
+    FUIntegrator(int1, &sim);
+    FUIntegrator(int2, &sim);
+    FUZOH(zoh, &sim);
+    FUSum(err, &sim);
+    FUUnitDelay(delay, &sim);
+    FUSum(acc, &sim);
+    FUSum(u, &sim);
+    FUSum(dx2, &sim);
+    FUOutput(out, &sim);
+    r->Set_OutValue(1);
+    zoh->Set_SampleTime(0.01);
+    delay->Set_SampleTime(0.01);
+    sim.connectU(int2, int1);
+    sim.connectU(dx2, int2);
+    sim.connectU(int1, zoh);
+    sim.connectU(r, err);
+    sim.connectU(zoh, err); err->Set_InputGain(-1);
+    sim.connectU(acc, delay);
+    sim.connectU(delay, acc);
+    sim.connectU(err, acc); acc->Set_InputGain(0.01);
+    sim.connectU(err, u); u->Set_InputGain(2);
+    sim.connectU(acc, u);
+    sim.connectU(u, dx2);
+    sim.connectU(int2, dx2); dx2->Set_InputGain(-0.5);
+    sim.connectU(int1, dx2); dx2->Set_InputGain(-1);
+    sim.connectU(int1, out);
+    sim.Set_EnableStore(false);
+    sim.Initialize();
+    auto t0 = chrono::steady_clock::now();
+    sim.Simulate();
+    auto t1 = chrono::steady_clock::now();
+    x1 = int1->Get_OutValue();
+    x2 = int2->Get_OutValue();
+    return chrono::duration<double>(t1-t0).count();
+}
+
+int main(int argc, char **argv) {
+    double endtime = argc>1 ? atof(argv[1]) : 100;
+    double sx1, sx2, dx1, dx2;
+    double ts = Run_Static(endtime, sx1, sx2);
+    double td = Run_Simulator(endtime, dx1, dx2);
+    cout.precision(17);
+    cout << "steps: " << int(endtime/0.001+0.5) << endl;
+    cout << "Simulator: " << td << " s  x1: " << dx1 << "  x2: " << dx2 << endl;
+    cout << "StaticModel: " << ts << " s  x1: " << sx1 << "  x2: " << sx2 << endl;
+    cout.precision(6);
+    cout << "speedup: " << td/ts << "  identical: "
+         << ((sx1==dx1) && (sx2==dx2) ? "yes" : "no") << endl;
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**********************
+Benchmark of limited data storage.
+It simulates a model with OUTPUT modules limited to "window" samples, which
+ are stored in ring buffers. Then the same amount of samples are replayed to
+ ring buffers alone, and to the former storage, which removed the front of a
+ vector for every sample after it was full. The former storage is skipped
+ for windows larger than 10^4, because it takes minutes to hours.
+Usage: bench_storage [steps] [outputs]
+**********************/
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "simucpp.hpp"
+using namespace simucpp;
+using namespace std;
+
+void Run(int steps, int outputs, int window) {
+    Simulator sim(steps*0.001);
+    UIntegrator *x = new UIntegrator(&sim);
+    USum *dx = new USum(&sim);
+    x->Set_InitialValue(1);
+    sim.connectU(x, dx); dx->Set_InputGain(-1);
+    sim.connectU(dx, x);
+    vector<UOutput*> outs;
+    for (int i=0; i<outputs; ++i) {
+        outs.push_back(new UOutput(&sim));
+        sim.connectU(x, outs.back());
+        outs.back()->Set_MaxDataStorage(window);
+    }
+    sim.Initialize();
+    auto t0 = chrono::steady_clock::now();
+    sim.Simulate();
+    double tring = chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+    cout << "window: " << window << "  simulation: " << tring << " s";
+    double v = 0;
+    t0 = chrono::steady_clock::now();
+    for (int i=0; i<outputs; ++i) {
+        RingBuffer ring(window);
+        for (int k=0; k<=steps; ++k) ring.Push(k);
+        v += ring[ring.Size()-1];
+    }
+    tring = chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+    cout << "  ring buffer: " << tring << " s (" << v << ")";
+    if (window <= 10000) {
+        v = 0;
+        t0 = chrono::steady_clock::now();
+        for (int i=0; i<outputs; ++i) {
+            vector<double> values;
+            for (int k=0; k<=steps; ++k) {
+                values.push_back(k);
+                if ((int)values.size() > window) values.erase(values.begin());
+            }
+            v += values.back();
+        }
+        double tvec = chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+        cout << "  vector erase: " << tvec << " s (" << v << ")";
+    }
+    cout << "  output: " << outs[0]->Get_StoredData().back() << endl;
+}
+
+int main(int argc, char **argv) {
+    int steps = argc>1 ? atoi(argv[1]) : 1000000;
+    int outputs = argc>2 ? atoi(argv[2]) : 4;
+    cout.precision(6);
+    for (int window=1000; window<=steps; window*=10)
+        Run(steps, outputs, window);
+    return 0;
+}
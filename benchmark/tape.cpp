@@ -0,0 +1,47 @@
+/**********************
+Benchmark of the instruction tape.
+It builds a large model of many nonlinear oscillators and compares the
+ simulation time among virtual function calls, the instruction tape and the
+ model compiled by JIT. Compilation time is not included.
+Usage: bench_tape [oscillators] [endtime]
+**********************/
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "models.hpp"
+using namespace simucpp;
+using namespace std;
+
+// mode: 0 for virtual function calls, 1 for the instruction tape, 2 for JIT.
+double Run(int n, double endtime, int mode, double &result, uint &stage) {
+    Simulator sim(endtime);
+    UOutput *out = new UOutput(&sim);
+    Build_Model(&sim, n, out);
+    sim.Set_EnableTape(mode > 0);
+    sim.Set_EnableJIT(mode == 2);
+    sim.Set_EnableStore(false);
+    sim.Initialize();
+    stage = sim.Get_StageCount();
+    auto t0 = chrono::steady_clock::now();
+    sim.Simulate();
+    auto t1 = chrono::steady_clock::now();
+    result = out->Get_OutValue();
+    return chrono::duration<double>(t1-t0).count();
+}
+
+int main(int argc, char **argv) {
+    int n = argc>1 ? atoi(argv[1]) : 10000;
+    double endtime = argc>2 ? atof(argv[2]) : 0.2;
+    double y1, y2, y3;
+    uint s1, s2, s3;
+    double tv = Run(n, endtime, 0, y1, s1);
+    double tt = Run(n, endtime, 1, y2, s2);
+    double tj = Run(n, endtime, 2, y3, s3);
+    cout.precision(6);
+    cout << "modules: " << 6*n+3 << "  steps: " << int(endtime/0.001+0.5) << endl;
+    cout << "virtual call: " << tv << " s  output: " << y1 << "  evaluations per stage: " << s1 << endl;
+    cout << "instruction tape: " << tt << " s  output: " << y2 << "  evaluations per stage: " << s2 << endl;
+    cout << "JIT: " << tj << " s  output: " << y3 << endl;
+    cout << "speedup of tape: " << tv/tt << "  speedup of JIT: " << tv/tj << endl;
+    return 0;
+}
@@ -0,0 +1,46 @@
+/**********************
+Scaling benchmark of multithreaded stages.
+It simulates the same oscillator model as "tape.cpp" on 1, 2, 4, ... threads
+ up to "maxthreads", and prints the time and speedup of every thread count.
+Usage: bench_threads [oscillators] [endtime] [maxthreads] [grain]
+**********************/
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include "models.hpp"
+using namespace simucpp;
+using namespace std;
+
+double Run(int n, double endtime, uint threads, uint grain, double &result) {
+    Simulator sim(endtime);
+    UOutput *out = new UOutput(&sim);
+    Build_Model(&sim, n, out);
+    sim.Set_EnableStore(false);
+    sim.Set_Threads(threads, grain);
+    sim.Initialize();
+    auto t0 = chrono::steady_clock::now();
+    sim.Simulate();
+    auto t1 = chrono::steady_clock::now();
+    result = out->Get_OutValue();
+    return chrono::duration<double>(t1-t0).count();
+}
+
+int main(int argc, char **argv) {
+    int n = argc>1 ? atoi(argv[1]) : 10000;
+    double endtime = argc>2 ? atof(argv[2]) : 0.2;
+    uint maxthreads = argc>3 ? atoi(argv[3]) : thread::hardware_concurrency();
+    uint grain = argc>4 ? atoi(argv[4]) : 256;
+    double y, t1 = 0, t;
+    if (maxthreads < 1) maxthreads = 1;
+    cout.precision(6);
+    cout << "modules: " << 6*n+3 << "  steps: " << int(endtime/0.001+0.5)
+         << "  grain: " << grain << endl;
+    for (uint threads=1; threads<=maxthreads; threads*=2) {
+        t = Run(n, endtime, threads, grain, y);
+        if (threads == 1) t1 = t;
+        cout << "threads: " << threads << "  time: " << t << " s  speedup: "
+             << t1/t << "  output: " << y << endl;
+    }
+    return 0;
+}
@@ -39,6 +39,18 @@ enum DIVERGENCE_MODE {
     DIVERGENCE_NONE,
 };
 
+enum SOLVER_TYPE {
+    SOLVER_RK4,     // Fixed-step 4-order Runge-Kutta.
+    SOLVER_RK45,    // Variable-step Dormand-Prince 5(4).
+    SOLVER_BDF2,    // Fixed-step implicit 2-order backward differentiation formula, for stiff models.
+};
+
+enum DELAY_INTERP {
+    INTERP_NEAREST,   // The nearest stored value.
+    INTERP_LINEAR,    // Linear interpolation of two stored values.
+    INTERP_LAGRANGE,  // Cubic Lagrange interpolation of four stored values.
+};
+
 
 /**
  * @brief The bus between two matrix modules has "row" and "column" properties.  
@@ -68,10 +80,11 @@ class UnitModule
 {
     friend class Simulator;
     friend class DeMux;
+    friend class UTransportDelay;
 public:
     UnitModule(Simulator *sim=nullptr, std::string name="unitmodule");
     virtual ~UnitModule();
-    virtual double Get_OutValue() const = 0;
+    double Get_OutValue() const { return *_outvalue; }
 
 protected:
     // Name of this unit module.
@@ -80,6 +93,10 @@ protected:
     PSimulator _sim = nullptr;
     // See private member function "Set_Enable".
     bool _enable;
+    // Output value of this module. It points to "_ov" until the simulator is initialized,
+    //  and then points to the slot of this module in "Simulator::_outvalues".
+    double *_outvalue;
+    double _ov;
 
 private:
     // Enable or disable this module. Mainly used for discrete modules.
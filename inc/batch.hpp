@@ -0,0 +1,77 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the class defination of BatchRunner, which runs many
+ independent simulations of one model on several threads.
+**********************/
+#ifndef SIMUCPP_BATCH_H
+#define SIMUCPP_BATCH_H
+#include <deque>
+#include <mutex>
+#include "simulator.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Every worker thread gets its own simulator, either a clone of an initialized
+ prototype or one built by a factory, and reuses it for every run it takes
+ by "Simulation_Reset()". Runs are divided into queues of workers, and a
+ worker steals runs from the others when its own queue is empty.
+Every run reseeds NOISE modules by the seed of the runner and its index, so
+ results don't depend on which worker runs it.
+**********************/
+class BatchRunner
+{
+public:
+    // Runs are simulated by clones of "proto", which must be initialized and
+    //  can be cloned. See "Simulator::Clone()".
+    // "threads" is the amount of worker threads, and 0 for all hardware threads.
+    BatchRunner(PSimulator proto, uint threads=0);
+    // Runs are simulated by initialized simulators returned by "factory", which
+    //  is called once by every worker thread. They are deleted by this runner.
+    BatchRunner(std::function<PSimulator()> factory, uint threads=0);
+    ~BatchRunner();
+
+    // Called before every run with its simulator and run index, to set
+    //  parameters of this run. It's called on worker threads concurrently,
+    //  so use "Simulator::Get_Module" to find modules of the simulator.
+    void Set_Setup(std::function<void(PSimulator, uint)> setup);
+    // Called after every run with its simulator and run index, to collect
+    //  results or reductions. It's called on worker threads concurrently.
+    void Set_Collect(std::function<void(PSimulator, uint)> collect);
+    // Set the seed of NOISE modules of every runs.
+    void Set_Seed(uint seed);
+    // Store the data of an OUTPUT module of the prototype in every runs.
+    // Return its index which is used by "Get_Data".
+    uint Add_Output(PUOutput m);
+
+    // Simulate "runs" runs, and return when all of them finished.
+    void Run(uint runs);
+    // Return the stored data of the "n"th added OUTPUT module in a run.
+    std::vector<double>& Get_Data(uint run, uint n);
+    // Return the value returned by "Simulate()" of a run.
+    int Get_Status(uint run);
+    // Return the wall time of the last "Run()" in seconds.
+    double Get_Time();
+    // Return the throughput of the last "Run()" in simulations per second.
+    double Get_Throughput();
+
+private:
+    // Work of a worker thread.
+    void Work(uint w);
+
+    PSimulator _proto;
+    std::function<PSimulator()> _factory;
+    std::function<void(PSimulator, uint)> _setup, _collect;
+    uint _threads, _seed;
+    std::vector<PUOutput> _outs;
+    // Stored data of OUTPUT modules, and its subscript index is "run*_outs.size()+n".
+    std::vector<std::vector<double>> _data;
+    std::vector<int> _status;
+    // Simulators and run queues of every worker threads.
+    std::vector<PSimulator> _sims;
+    std::vector<std::deque<uint>> _queues;
+    std::vector<std::mutex> _mtx;
+    double _time;
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // SIMUCPP_BATCH_H
@@ -0,0 +1,96 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the class defination of CompressedSeries, which stores
+ data of OUTPUT modules and time points in compressed blocks.
+**********************/
+#ifndef SIMUCPP_COMPRESS_H
+#define SIMUCPP_COMPRESS_H
+#include <deque>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include "baseclass.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+A series of doubles compressed losslessly by XOR encoding (Gorilla).
+Every value is XORed with its prediction, and the result is written as a
+ single 0 bit if it's zero, or by its meaningful bits, whose window of
+ leading and trailing zeros is reused when possible. The prediction is the
+ previous value, or in delta mode, linear extrapolation of the previous two
+ values, so that evenly spaced values such as time points cost 1 or 2 bits.
+Values are divided into blocks of "blocksize", and every block begins with a
+ raw value, so that a block can be decoded alone.
+**********************/
+class CompressedSeries
+{
+public:
+    class Iterator;
+    CompressedSeries(bool delta=false, uint blocksize=1024);
+    void Push(double v);
+    void Clear();
+    // Remove the first "n" values.
+    void Drop_Front(size_t n);
+    size_t Size() const;
+    // Memory used by compressed blocks in bytes.
+    size_t Get_Bytes() const;
+    // Value "n", which decodes its block unless the block is the last one
+    //  decoded by it, so reading values in order decodes every block once.
+    // The decoded block is cached in this object, so it's not thread-safe.
+    double At(size_t n) const;
+    // Decode all values to "out".
+    void Decode(std::vector<double> &out) const;
+    // Iterate all values and decode a block at a time.
+    Iterator begin() const;
+    Iterator end() const;
+private:
+    struct Block {
+        std::vector<uint64_t> words;
+        size_t nbits;
+        uint count;
+    };
+    void Put(Block &b, uint64_t v, uint n);
+    // Decode block "n" to "out", and return the amount of values.
+    uint Decode_Block(size_t n, double *out) const;
+    bool _delta;
+    uint _size;  // Amount of values of a full block
+    std::deque<Block> _blocks;
+    // @_skip: Amount of dropped values in the first block.
+    // @_prev, @_prev2: Last two values pushed.
+    // @_lead, @_trail: Window of meaningful bits of the last XOR, and -1 for none.
+    // @_first: Amount of blocks dropped before the first one.
+    size_t _skip, _first;
+    double _prev, _prev2;
+    int _lead, _trail;
+    // Block decoded by "At()", which is block "_cacheblock" counted from the
+    //  first block ever pushed and has "_cachecount" values when it's decoded.
+    mutable std::vector<double> _cache;
+    mutable size_t _cacheblock;
+    mutable uint _cachecount;
+    friend class Iterator;
+};
+
+class CompressedSeries::Iterator
+{
+public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef double value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const double* pointer;
+    typedef double reference;
+    Iterator(const CompressedSeries *s, size_t n);
+    double operator*() const;
+    Iterator& operator++();
+    bool operator==(const Iterator &it) const { return _n == it._n; }
+    bool operator!=(const Iterator &it) const { return _n != it._n; }
+private:
+    void Load();
+    const CompressedSeries *_s;
+    size_t _n;      // Index of the value
+    size_t _block;  // Index of the block in "_buf"
+    std::vector<double> _buf;
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // SIMUCPP_COMPRESS_H
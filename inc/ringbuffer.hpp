@@ -0,0 +1,46 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the class defination of RingBuffer, which stores the
+ latest data of OUTPUT modules and time points when their storage is limited.
+**********************/
+#ifndef SIMUCPP_RINGBUFFER_H
+#define SIMUCPP_RINGBUFFER_H
+#include <vector>
+#include "traceview.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+A bounded buffer of doubles, which overwrites its oldest value when it's full.
+Its memory is allocated by "Set_Capacity()", so "Push()" doesn't allocate.
+Values are in two contiguous spans, the older one beginning at the oldest
+ value, and the newer one beginning at the front of the buffer.
+**********************/
+class RingBuffer
+{
+    friend class Simulator;
+public:
+    RingBuffer(size_t capacity=0);
+    // Change the capacity and keep the latest values, and 0 to free memory.
+    void Set_Capacity(size_t capacity);
+    size_t Capacity() const;
+    size_t Size() const;
+    void Push(double v) {
+        _buf[_head] = v;
+        if (++_head == _buf.size()) _head = 0;
+        if (_size < _buf.size()) ++_size;
+    }
+    void Clear();
+    // Value "n", and value 0 is the oldest one.
+    double operator[](size_t n) const;
+    void Get_Spans(TraceView &older, TraceView &newer) const;
+    // Copy all values to "out" from the oldest one.
+    void Copy(std::vector<double> &out) const;
+private:
+    std::vector<double> _buf;
+    // @_head: Position of the next value.
+    // @_size: Amount of stored values.
+    size_t _head, _size;
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // SIMUCPP_RINGBUFFER_H
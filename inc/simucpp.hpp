@@ -1,6 +1,9 @@
 #ifndef SIMUCPP_HEADER_H
 #define SIMUCPP_HEADER_H
 #include "packmodules.hpp"
+#include "batch.hpp"
+#include "trace.hpp"
+#include "staticmodel.hpp"
 
 #define SIMUCPP_CONTINUOUS                        true
 #define SIMUCPP_DISCRETE                          false
@@ -4,10 +4,126 @@ This file contains the class defination of Simulator.
 **********************/
 #ifndef SIMUCPP_SIMULATOR_H
 #define SIMUCPP_SIMULATOR_H
+#include <random>
+#include <memory>
+#include <mutex>
+#include <chrono>
 #include "matmodules.hpp"
 NAMESPACE_SIMUCPP_L
 
 
+/**********************
+Instruction of the tape which is lowered from sequence tables.
+Every instruction updates one unit module, and its operands are slots of
+ "Simulator::_outvalues", which are the same as IDs of unit modules.
+See "Simulator::Build_Tape()" for details.
+**********************/
+enum TAPE_OPCODE {
+    TAPE_SUM,       // Sum of "cnt" operands multiplied by their input gains.
+    TAPE_GAIN,      // One operand multiplied by its gain.
+    TAPE_PRODUCT,   // Product of "cnt" operands multiplied by their input gains.
+    TAPE_FCN,       // User function of one operand.
+    TAPE_FCNMISO,   // User function of "cnt" operands.
+    TAPE_UPDATE,    // Call "Module_Update()" of the module.
+    TAPE_DISCRETE,  // Call "Module_Update()" of the module only at its sample hits.
+    TAPE_LINEAR,    // Linear block "arg" in "Simulator::_linear".
+    TAPE_LOOP,      // Algebraic loop "arg" in "Simulator::_loops".
+};
+struct TapeCode {
+    u8 op;  // See enum "TAPE_OPCODE".
+    uint dst;  // Slot of the output value.
+    uint arg, cnt;  // Index of the first operand and amount of operands.
+    PUnitModule m;  // The module to be updated.
+};
+
+/**********************
+Linear block merged from SUM and GAIN instructions of the stage schedule.
+It computes "y=M*u", where "u" is the slots "in" and "y" is the slots "out",
+ and "M" is stored as a dense row-major matrix, or in CSR format if it's
+ sparse. See "Simulator::Build_Linear()" for details.
+**********************/
+struct LinearBlock {
+    std::vector<uint> in, out;
+    bool dense;
+    // Dense matrix, or nonzero elements of CSR and their column indexes.
+    std::vector<double> val;
+    std::vector<uint> col;
+    // Offsets of every rows in "val" of CSR.
+    std::vector<uint> row;
+    // Gathered input values.
+    std::vector<double> u;
+};
+
+/**********************
+Algebraic loop, which is a strongly connected component of modules whose
+ outputs depend on each other in a stage. Output values of "tear" modules
+ are solved by Newton iterations, and other modules are updated in "order"
+ from them. See "Simulator::Build_Loops()" for details.
+**********************/
+struct AlgebraicLoop {
+    std::vector<uint> order, tear;
+    // LU decomposition of the Jacobian of residuals, reused across steps.
+    std::vector<double> jacob;
+    std::vector<int> piv;
+    bool factorized, warned;
+    // Values of torn modules, residuals, and temporary values.
+    std::vector<double> z, r, r1, dz;
+};
+
+/**********************
+Parameter of a unit module which can be changed after initialization.
+See "Simulator::Get_Parameter()" for details.
+**********************/
+enum PARAM_KIND {
+    PARAM_GAIN,     // Gain of a GAIN module.
+    PARAM_INGAIN,   // Input gain of a port of a SUM or PRODUCT module.
+    PARAM_VALUE,    // Output value of a CONSTANT module.
+    PARAM_INITIAL,  // Initial value of an INTEGRATOR module.
+};
+struct Parameter {
+    uint id, port;  // ID of the module and its input port.
+    u8 kind;  // See enum "PARAM_KIND".
+    int arg;  // Index of its copy in "Simulator::_tapegains", or -1.
+    int merged;  // Index of its gain in "Simulator::_merged", or -1.
+};
+
+/**********************
+Input gain of a SUM, GAIN or PRODUCT module which gains bypassed by the
+ optimizer are merged into. The module holds "gain" multiplied by "factor".
+**********************/
+struct MergedGain {
+    PUnitModule m;
+    uint port;
+    double gain, factor;  // Gain set by users, and product of merged gains.
+};
+
+/**********************
+Statistics of simulation steps paced by the wall clock, where latencies are
+ in seconds. See "Simulator::Set_EnableRealTime()" for details.
+**********************/
+struct RealTimeStats {
+    uint steps, overruns;
+    double p50, p99, max;
+};
+
+/**********************
+Next sample hit of a discrete module. The comparison is reversed so that
+ "std::make_heap" builds a min-heap ordered by time.
+**********************/
+struct SampleHit {
+    double t;
+    uint id;
+    bool operator<(const SampleHit &hit) const {
+        return t>hit.t || (t==hit.t && id>hit.id); }
+};
+
+
+// Function of a segment of the tape compiled by JIT. See "Simulator::Build_JIT()".
+typedef void (*JitFcn)(double *v, double *dx, void *sim,
+    void (*update)(void*, uint), double (*fcn)(void*, uint, double));
+
+class ThreadPool;
+struct StateBlob;
 class Simulator
 {
     // All kinds of unit modules.
@@ -40,6 +156,21 @@ public:
     Simulator(double endtime=10);
     ~Simulator();
 
+    // Return a deep copy of this initialized simulator, which has copies of
+    //  every unit modules, sequence tables, instruction tape and the current
+    //  simulation state. The copy owns and deletes its modules, and it can run
+    //  on another thread. Functions of FCN, FCNMISO and INPUT modules are
+    //  copied, so their captured references are shared with this simulator.
+    // Sinks of OUTPUT modules aren't copied, so OUTPUT modules of the copy
+    //  store data to memory. See "UOutput::Set_Sink()".
+    // Only modules of the classes in "unitmodules.hpp" can be copied, and it
+    //  returns nullptr with a warning if there are modules of other classes.
+    Simulator* Clone();
+    // Return the module of this simulator which has the same ID as "m", which
+    //  is used to find the copy of "m" in a simulator returned by "Clone()".
+    PUnitModule Get_Module(PUnitModule m);
+    template<typename T> T* Get_Module(T *m) { return (T*)Get_Module((PUnitModule)m); }
+
 /**********************
 The following 3 groups of functions are uesd to build connections
     between modules. Each function accepts 2 parameters of modules "m1"
@@ -92,6 +223,21 @@ As for PackModule, default zero if port is not specified.
     // and it should be called from the second and subsequent simulation.
     void Simulation_Reset();
 
+    // Save the current simulation state to a compact binary blob. It has the
+    //  time, output values of all modules, states of solvers and the event
+    //  calendar, and internal states of modules: previous values of UNITDELAY
+    //  and TRANSPORTDELAY modules, sample counters of INPUT modules and random
+    //  number generators of NOISE modules and lanes. Stored data of OUTPUT
+    //  modules isn't included. A blob is only valid for this simulator and its
+    //  clones in the same program.
+    // "state" is reused, so saving to the same blob again doesn't allocate memory.
+    void SaveState(std::vector<u8> &state);
+    std::vector<u8> SaveState();
+    // Restore a state saved by "SaveState()", and then the simulation continues
+    //  from it. It doesn't allocate memory, so a simulation can be restored and
+    //  stepped many times, e.g. rollouts of model-predictive control.
+    void RestoreState(const std::vector<u8> &state);
+
     // Run a simulation once or step by step.
     // They return 0 for everything is normal and others for some errors.
     int Simulate();
@@ -103,6 +249,9 @@ As for PackModule, default zero if port is not specified.
     // If set false, then function "Simulator::Plot()" won't be executed.
     // It will also set all the OUTPUT modules.
     void Set_EnableStore(bool store=true);
+    // Whether to compress data stored in memory, including time points and
+    //  data of all OUTPUT modules. See "UOutput::Set_EnableCompress()".
+    void Set_EnableCompress(bool compress=true);
     // Set storage interval of all OUTPUT modules.
     // It means how long do every OUTPUT modules store a data.
     // Notice: It changes only OUTPUT modules, not others.
@@ -110,6 +259,11 @@ As for PackModule, default zero if port is not specified.
 
     // Draw a waveform by using the stored data in every OUTPUT modules.
     void Plot();
+    // Save time points and data stored in OUTPUT modules to a columnar trace
+    //  file, which is read by "TraceReader". OUTPUT modules with sinks aren't
+    //  saved. Data limited by "UOutput::Set_MaxDataStorage()" are the latest
+    //  ones, so they are aligned to the end of time points. Return 0 for success.
+    int Save_Trace(std::string filename);
 
     // Get and set current simulation time.
     void Set_t(double t);
@@ -118,9 +272,159 @@ As for PackModule, default zero if port is not specified.
     void Set_Endtime(double t);
     double Get_Endtime();
     // Get and set simulation step.
+    // It's the initial step when a variable-step solver is used.
     void Set_SimStep(double step=0.001);
     double Get_SimStep();
 
+    // Set the ODE solver. See enum "SOLVER_TYPE".
+    // Variable-step solvers don't step over sample hits of discrete modules.
+    void Set_Solver(int solver=SOLVER_RK4);
+    // Set tolerances of the local error of variable-step solvers.
+    // They are also used to check convergence of Newton iterations of implicit solvers.
+    void Set_Tolerance(double reltol=1e-3, double abstol=1e-6);
+    // Set the maximum step of variable-step solvers. -1 for no limitation.
+    void Set_MaxStep(double step=-1);
+    // Return how many steps have been accepted, or rejected if "rejected" is true.
+    uint Get_StepCount(bool rejected=false);
+    // Return how many times the Jacobian is evaluated by implicit solvers.
+    uint Get_JacobianCount();
+    // Return how many modules are evaluated in every stage of solvers, which
+    //  is the length of the stage schedule built in "Initialize()", or the
+    //  amount of its instructions if the instruction tape is enabled.
+    uint Get_StageCount();
+
+    // Whether to run the instruction tape built in "Initialize()" in every simulation step.
+    // If set false, every module will be updated by calling its virtual function
+    //  "Module_Update()" according to the sequence tables.
+    void Set_EnableTape(bool tape=true);
+
+    // Update the stage schedule on "threads" threads when the instruction tape
+    //  is enabled. Modules of the same level in the dependency graph are
+    //  divided among threads, and threads wait for each other between levels.
+    // "grain" is the least amount of modules updated by one thread in a level.
+    //  Levels smaller than 2*grain are updated by the calling thread alone, so
+    //  small models don't pay for synchronization.
+    void Set_Threads(uint threads=1, uint grain=256);
+
+    // Whether to generate C++ source of the instruction tape in "Initialize()",
+    //  compile it by the system compiler and load it to run simulation steps.
+    // Compiled models are cached in directory "dir", "$XDG_CACHE_HOME/simucpp_jit"
+    //  or "$HOME/.cache/simucpp_jit" by default, and named by the hash of their
+    //  sources. The directory and libraries in it must be owned by this user and
+    //  not writable by others. The compiler is "$CXX" or "c++", which is run
+    //  without a shell. The instruction tape is used if compilation fails or
+    //  the platform doesn't support it.
+    void Set_EnableJIT(bool jit=true, std::string dir="");
+    // Return whether the compiled model is used.
+    bool Get_EnableJIT();
+
+    // Whether to merge SUM and GAIN modules of the stage schedule into linear
+    //  blocks in "Initialize()", which compute every values needed by other
+    //  modules and INTEGRATOR modules from their inputs by one matrix. Values
+    //  are rounded differently, and output values of modules only used inside
+    //  a linear block are no longer updated.
+    void Set_EnableLinear(bool linear=true);
+    // Return how many modules are merged into linear blocks.
+    uint Get_LinearCount();
+
+    // Whether to optimize the graph of unit modules in "Initialize()":
+    //  - SUM, GAIN and PRODUCT modules whose inputs are only CONSTANT modules
+    //    are folded into CONSTANT modules;
+    //  - GAIN modules with gain 1 and SUM modules with one input of gain 1 are
+    //    bypassed;
+    //  - chained GAIN modules and single-input SUM modules are merged into
+    //    the gains of GAIN, SUM and PRODUCT modules which read them;
+    //  - modules which don't reach any INTEGRATOR, UNITDELAY or OUTPUT module
+    //    are removed from this simulator.
+    // CONSTANT modules are treated as constants, and removed modules are
+    //  no longer updated and their IDs are -1.
+    void Set_EnableOptimize(bool optimize=true);
+    // Return how many modules are removed by the optimization.
+    uint Get_RemovedCount();
+    // Return how many algebraic loops are found in "Initialize()". Every loop
+    //  is solved by Newton iterations in every stage, which start from its
+    //  solution in the last stage.
+    uint Get_LoopCount();
+
+    // Simulate "lanes" variants of this model together in ensemble mode, and
+    //  every output value holds "lanes" values. It must be called before
+    //  "Initialize()", and only arithmetic, INPUT, NOISE and OUTPUT modules
+    //  are supported besides INTEGRATOR modules.
+    // Lane 0 is the same as the model itself, and other lanes start as its
+    //  copies until they are changed by the following functions, which must be
+    //  called after "Initialize()".
+    void Set_Ensemble(uint lanes=1);
+    uint Get_Lanes();
+    // Set the gain of a GAIN module in a lane.
+    void Set_LaneGain(PUGain m, uint lane, double gain);
+    // Set the initial value of an INTEGRATOR module in a lane.
+    void Set_LaneInitialValue(PUIntegrator m, uint lane, double value);
+    // Set the seed of random numbers of NOISE modules in a lane, which is mixed
+    //  with the seed of every module. Default is the lane index. It can be
+    //  called before "Initialize()", and lane 0 always uses seeds of modules.
+    void Set_LaneSeed(uint lane, uint seed);
+    // Return the stored data of an OUTPUT module in a lane, which are decoded
+    //  to memory if they are limited or compressed, like "UOutput::Get_StoredData()".
+    std::vector<double>& Get_LaneData(PUOutput m, uint lane);
+
+    // Reseed every NOISE modules and lanes by seeds derived from "seed" and
+    //  their IDs, so that a simulation is reproduced by the same "seed".
+    void Set_NoiseSeed(uint seed);
+
+    // Set ports of co-simulation before "Initialize()". Input ports are CONSTANT
+    //  modules whose values are set by the co-simulation master, and output
+    //  ports are modules updated in simulation except INTEGRATOR modules.
+    // Slots of the ports are arranged to be contiguous in "Initialize()", so
+    //  port values are exchanged by one copy, or read and written in place by
+    //  the pointers returned by "Get_CoInputs()" and "Get_CoOutputs()", which
+    //  are only available in initialized simulators without ensemble mode.
+    void Set_CoPorts(const std::vector<PUConstant> &inputs, const std::vector<PUnitModule> &outputs);
+    void Set_CoInputs(const double *u);
+    void Get_CoOutputs(double *y);
+    double* Get_CoInputs();
+    const double* Get_CoOutputs();
+    // Advance the simulation by a communication step "commstep", which is made
+    //  up of simulation steps, and then output ports hold their values at the
+    //  new communication point. It doesn't support ensemble mode.
+    // It returns 0 for everything is normal and others for some errors.
+    int DoStep(double commstep);
+
+    // Whether to pace "Simulate_OneStep()" by a monotonic wall clock, so that
+    //  simulation time goes as fast as real time. A step waits for its
+    //  deadline by sleeping, and then spinning in the last "spin" seconds.
+    // Latencies from the release of every step to its end are counted in a
+    //  histogram allocated here, so paced steps don't allocate memory.
+    void Set_EnableRealTime(bool realtime=true, double spin=2e-4);
+    // Return how many steps are paced and overrun their deadlines, and the
+    //  median, 99th percentile and maximum of their latencies. Percentiles
+    //  are upper bounds of histogram bins, whose width is 2.3%.
+    // They are cleared by "Simulation_Reset()".
+    RealTimeStats Get_RealTimeStats();
+
+    // Return a handle of a parameter of a unit module of this initialized
+    //  simulator, or -1 if it doesn't exist. Names of parameters are:
+    //  "gain": gain of a GAIN module;
+    //  "ingain": input gain of port "port" of a SUM or PRODUCT module, where
+    //    ports of gain 0 have been deleted unless the SUM module is redundant;
+    //  "value": output value of a CONSTANT module;
+    //  "initial": initial value of an INTEGRATOR module.
+    // Handles are indexes, so they are also valid in clones of this simulator.
+    // Modules removed by optimization or merged into linear blocks can't be
+    //  changed, and -1 is returned for them. Neither can modules folded from
+    //  CONSTANT modules unless they are set by "UConstant::Set_Tunable()"
+    //  before initialization.
+    // The compiled model is no longer used after a gain is changed by
+    //  "Set_Parameter()", because gains are constants in it.
+    int Get_Parameter(PUnitModule m, std::string name, uint port=0);
+    // Queue a new value of a parameter. Queued values are applied together at
+    //  the beginning of the next simulation step or by "Simulation_Reset()",
+    //  without rebuilding the model. It can be called from another thread.
+    void Set_Parameter(int handle, double value);
+    // Return the current value of a parameter.
+    double Get_ParameterValue(int handle);
+    // Apply queued values of parameters now.
+    void Apply_Parameters();
+
     // Set how the simulator works when the simulation diverged.
     // 0: Default, Print a message and stop the program.
     // 1: Print a message and keep going on, and return a none-zero value after simulation.
@@ -131,23 +435,150 @@ As for PackModule, default zero if port is not specified.
     void Set_DivergenceCheckMode(int mode=0);
 
 private:
+    // Memberwise copy, only used by "Clone()" before copying modules.
+    Simulator(const Simulator &sim) = default;
+    Simulator& operator=(const Simulator &sim) = delete;
+    // Return a copy of a unit module, or nullptr if its class is unknown. See function "Clone()".
+    static PUnitModule Clone_Module(PUnitModule m);
+    // Return the "n"th child slot of a unit module, or nullptr if it doesn't exist.
+    static PUnitModule* Child_Slot(PUnitModule m, uint n);
+    // Return true if "m" is a GAIN module or a SUM module of one input, and
+    //  get its gain "g" and input "in".
+    static bool Gain_Of(PUnitModule m, double &g, PUnitModule &in);
+
+    // Optimize the graph of unit modules. See function "Set_EnableOptimize".
+    void Optimize_Modules();
+    // Return whether a module is folded into a constant, and evaluate it.
+    bool Fold_Constant(PUnitModule m, std::vector<u8> &state);
+    // Return the index of the input gain of port "port" of "m" in "_merged", or -1.
+    int Find_Merged(PUnitModule m, uint port);
+
     // Add a module to this simulator.
     void Add_Module(const PUnitModule m);
     void Add_Module(const PMatModule m);
 
+    // Find algebraic loops and build "_depends".
+    void Build_Loops();
+    // Choose torn modules of an algebraic loop and the order of other modules.
+    void Build_Loop(const std::vector<uint> &scc, const std::vector<std::vector<uint>> &child);
+    // Solve an algebraic loop by Newton iterations.
+    void Solve_Loop(AlgebraicLoop &loop);
+    // Update modules of an algebraic loop whose torn modules are "z", and
+    //  save residuals of torn modules to "r" if it isn't nullptr.
+    void Loop_Update(AlgebraicLoop &loop, const double *z, double *r);
+    // Update a module, or solve the algebraic loop which it represents.
+    void Update_Module(uint id);
     // Build connection of Endpoint modules.
-    void Build_Connection(std::vector<uint> &ids);
+    void Build_Connection(std::vector<uint> &ids, std::vector<u8> &added);
     // Print all modules and their connections.
     void Print_Modules();
 
+    // Merge sequence tables of INTEGRATOR modules into "_stageIDs".
+    void Build_Stage();
+    // Lower the sequence tables into an instruction tape.
+    void Build_Tape();
+    // Append instructions of a sequence table to the tape.
+    void Build_Tape(std::vector<uint> &ids, int end);
+    // Append the instruction of a module to the tape.
+    void Build_Tape(uint id);
+    // Run instructions of the tape from "begin" to "end".
+    // "buf" is used for temporary input values of FCNMISO modules.
+    void Run_Tape(uint begin, uint end, double *buf);
+    // Update every modules in sequence tables of INTEGRATOR modules,
+    //  and save derivatives of every INTEGRATOR modules to "dx".
+    void Stage_Update(double *dx);
+    // Set "x=_outref+h*k" for INTEGRATOR modules, then update them as above.
+    void Stage_Update(double *dx, const double *k, double h);
+    // Divide levels of the stage schedule into phases of threads.
+    void Build_Phase();
+    // Work of a thread in a stage. See function "Stage_Update".
+    void Stage_Work(uint w, double *dx, const double *k, double h);
+
+    // Generate C++ source of the tape, and compile and load it.
+    std::string Jit_Source();
+    void Build_JIT();
+    // Run the "i"th instruction of the tape, called by compiled models.
+    static void Jit_Update(void *sim, uint i);
+    // Call the function of the FCN module of the "i"th instruction.
+    static double Jit_Fcn(void *sim, uint i, double u);
+
+    // Merge SUM and GAIN instructions of the stage schedule into linear blocks.
+    void Build_Linear();
+    // Append slots read by an instruction to "reads".
+    void Tape_Reads(const TapeCode &code, std::vector<uint> &reads);
+    // Compute output values of a linear block.
+    void Run_Linear(LinearBlock &b);
+
+    void Update_StoreTime();
+    void Store_Time();
+    std::vector<double>& Get_TimeData();
+    // Anchor the wall clock and pace a step. See function "Set_EnableRealTime".
+    void RealTime_Begin();
+    void RealTime_Pace();
+    void Reset_RealTime();
+
+    // Save or restore the simulation state. See function "SaveState".
+    void Transfer_State(StateBlob &blob);
+    static void Module_State(PUnitModule m, StateBlob &blob);
+
+    // Build per-lane parameters of ensemble mode after the tape is built.
+    void Build_Lanes();
+    // Reset INTEGRATOR modules, stored data and random numbers of every lanes.
+    void Reset_Lanes();
+    // Reseed random number generators of NOISE modules in a lane except lane 0.
+    void Seed_Lane(uint lane);
+    // Run instructions of the tape on every lanes in ensemble mode.
+    void Run_Lanes(uint begin, uint end, double *buf);
+    // Update a module which isn't arithmetic on every lanes, whose output
+    //  values are "y".
+    void Lane_Update(PUnitModule m, double *y);
+
+    // Integrate from "_outref" to next step by different solvers.
+    void Solve_RK4();
+    void Solve_RK45();
+    void Solve_BDF2();
+    // Evaluate the Jacobian of derivatives of INTEGRATOR modules at "_outref".
+    void Jacobian_Update();
+    // Return the earliest time after "_t" when a discrete module samples.
+    double Next_SampleHit();
+
+    // Rebuild the event calendar with every first sample hits at time 0.
+    void Schedule_Reset();
+    // Pop the due sample hits of current step and enable their modules.
+    void Schedule_Update();
+    // Disable modules enabled by "Schedule_Update" after their updates.
+    void Schedule_Clear();
+    // Return sample time of a discrete module, or -1 for other modules.
+    double Get_SampleTime(PUnitModule m);
+
     // Simulation step and end time.
     double _H, _endtime;
 
     // Number of total modules, INTEGRATOR/UNITDELAY/OUTPUT modules.
     uint _cntM, _cntI, _cntD, _cntO;
+    // Length of the state vector, which is "_cntI" times "_lanes".
+    uint _cntX;
 
-    // Parameters for 4-order runge-kutta algorithm.
-    double *_ode4K[4];
+    // Parameters for runge-kutta algorithms.
+    double *_odeK[7];
+    // See public member function "Set_Solver".
+    int _solver;
+    // @_hstep: Step of variable-step solvers in next simulation step.
+    // @_hmax, _reltol, _abstol: See public member function "Set_MaxStep" and "Set_Tolerance".
+    double _hstep, _hmax, _reltol, _abstol;
+    // See public member function "Get_StepCount" and "Get_JacobianCount".
+    uint _cntstep, _cntreject, _cntjacob;
+    // Jacobian, its factorized iteration matrix and pivots, used by implicit solvers.
+    // @_jacobgh: The factor of Jacobian in the factorized iteration matrix.
+    // @_jacobstate: BIT0 for evaluated Jacobian and BIT1 for factorized iteration matrix.
+    // @_xprev: States of INTEGRATOR modules at the previous step, and
+    //  "_hasprev" is set when they're valid.
+    // They're allocated by "Initialize()" if BDF2 is used.
+    std::vector<double> _jacob, _jacoblu, _xprev;
+    std::vector<int> _jacobpiv;
+    bool _hasprev;
+    double _jacobgh;
+    u8 _jacobstate;
 
     // Temporarily save output value of every integrator.
     std::vector<double> _outref;
@@ -161,8 +592,8 @@ private:
     // 3 kinds of pointers below are pointers to endpoint modules.
     // The reason why they should exist is they all have some private members or
     //  member functions that different to others and should be treated distunguishly.
-    // "_integrators" has private member variations "_outvalue"
-    //  which will be called in "Simulate_OneStep()".
+    // "_integrators" are the first "_cntI" modules after initialization, so their
+    //  output values are the state vector at the beginning of "_outvalues".
     // "_outputs" has private member variations "_values"
     //  which will be called in "Plot()".
     // "_unitdelays" has private member functions "Output_Update()"
@@ -171,23 +602,149 @@ private:
     std::vector<PUOutput> _outputs;
     std::vector<PUUnitDelay> _unitdelays;
 
+    // Output value of every unit modules, and its subscript index is module ID.
+    // Its size is fixed in "Initialize()" and every modules read and write their
+    //  own slots in it since then.
+    std::vector<double> _outvalues;
+
     // IDs of every Endpoint modules according to the their updating orders.
     // First ID of every vector is an Endpoint module.
-    // @_discIDs: Its name is "_allIDs" in previous version. Itis used to make
-    //  sure that every modules will update only once in every simulation step,
-    //  and it will be reused as discrete ids after building sequence table.
+    // @_discIDs: IDs of scheduled discrete modules.
     std::vector<std::vector<uint>> _integIDs, _delayIDs, _outIDs;
     std::vector<int> _discIDs;
+    // IDs of modules updated in every stage of solvers, merged from "_integIDs".
+    std::vector<uint> _stageIDs;
+    // Slots of the child module of every INTEGRATOR modules.
+    std::vector<uint> _stagederiv;
+    // Offsets of every levels in "_stageIDs", sorted by their depth from
+    //  INTEGRATOR modules. Modules in the same level don't depend on each other.
+    std::vector<uint> _stagelvl;
+    // IDs of every TRANSPORTDELAY modules, whose delay times limit steps of variable-step solvers.
+    std::vector<uint> _trdIDs;
+    // IDs of NOISE modules generating values in every step. See function "DoStep".
+    std::vector<uint> _noiseIDs;
+
+    // Event calendar of discrete modules. See function "Schedule_Update".
+    std::vector<SampleHit> _hits;
+    // Set when the sample hit of a module is due in current step, and its
+    //  subscript index is module ID.
+    std::vector<u8> _due;
+    // IDs of modules whose sample hits are due in current step.
+    std::vector<uint> _fired;
+
+    // Instruction tape lowered from "_integIDs", "_delayIDs" and "_outIDs".
+    // "_tapeseg" divides it into 3 segments in the same order.
+    std::vector<TapeCode> _tape;
+    uint _tapeseg[4];
+    // Operands and their gains of every instructions.
+    std::vector<uint> _tapeargs;
+    std::vector<double> _tapegains;
+    // Temporary input values of FCNMISO modules.
+    // @_tapebufw: Length of the temporary input values used by a thread.
+    std::vector<double> _tapebuf;
+    uint _tapebufw;
+    // Offsets of every levels of the stage schedule in "_tape".
+    std::vector<uint> _tapelvl;
+
+    // Linear blocks of "TAPE_LINEAR" instructions. See function "Set_EnableLinear".
+    // @_cntlinear: Amount of modules merged into linear blocks.
+    std::vector<LinearBlock> _linear;
+    uint _cntlinear;
+    // Amount of modules removed by "Optimize_Modules()".
+    uint _cntremoved;
+    // CONSTANT modules created by "Optimize_Modules()" for folded modules.
+    std::vector<PUnitModule> _foldmodules;
+    // Gains which other gains are merged into by "Optimize_Modules()".
+    std::vector<MergedGain> _merged;
+
+    // Algebraic loops. See function "Build_Loops".
+    // @_depends: IDs of modules which every module reads in a stage, except
+    //  INTEGRATOR and UNITDELAY modules. Modules of an algebraic loop are
+    //  represented by the first module of it.
+    // @_loopidx: Index in "_loops" of the loop which every module represents, or -1.
+    std::vector<AlgebraicLoop> _loops;
+    std::vector<std::vector<uint>> _depends;
+    std::vector<int> _loopidx;
+
+    // Threads and the phases of the stage schedule. See function "Set_Threads".
+    // Every phase has "_threads+1" offsets in "_tape", and thread "w" runs
+    //  instructions between offsets "w" and "w+1". It's empty if the stage
+    //  schedule is updated by the calling thread alone.
+    ThreadPool *_pool;
+    uint _threads, _grain;
+    std::vector<uint> _phaseseg;
+
+    // Ensemble mode. See public member function "Set_Ensemble".
+    // @_lanegains: Gains of every instructions in every lanes.
+    // @_lanearg: Index of the first operand of the instruction of every modules,
+    //  or -1 if the module isn't in the tape.
+    // @_laneinit: Initial values of INTEGRATOR modules in every lanes.
+    // @_laneout: Index of every OUTPUT modules in "_outputs".
+    // @_lanedata: Stored data of OUTPUT modules in lanes except lane 0.
+    // @_lanering: Limited data of them. See "UOutput::Set_MaxDataStorage".
+    // @_lanepacked: Compressed data of them. See "UOutput::Set_EnableCompress".
+    // @_lanenoise: Index of every NOISE modules, whose random number generator
+    //  of lane "l" is "_lanerng[index*(_lanes-1)+l-1]".
+    uint _lanes;
+    std::vector<double> _lanegains, _laneinit;
+    std::vector<int> _lanearg;
+    std::vector<uint> _laneout, _laneseed, _lanenoise;
+    std::vector<std::vector<double>> _lanedata;
+    std::vector<RingBuffer> _lanering;
+    std::vector<CompressedSeries> _lanepacked;
+    std::vector<std::mt19937> _lanerng;
+
+    // Real-time pacing. See public member function "Set_EnableRealTime".
+    // @_rtanchor: Wall-clock time when simulation time is "_rtt0".
+    // @_rtstart: Simulation time at the beginning of current step.
+    // @_rthist: Histogram of latencies of steps.
+    std::chrono::steady_clock::time_point _rtanchor;
+    double _rtt0, _rtstart, _rtspin, _rtmax;
+    bool _rtanchored;
+    uint _rtsteps, _rtoverruns;
+    std::vector<uint> _rthist;
+
+    // Input and output ports of co-simulation. See public member function "Set_CoPorts".
+    std::vector<PUnitModule> _coinputs, _cooutputs;
+
+    // Parameters of modules. See public member function "Get_Parameter".
+    // @_parampending: Queued handles and values, guarded by "_parammutex".
+    // @_paramapply: Values being applied, swapped with "_parampending".
+    std::vector<Parameter> _params;
+    std::vector<std::pair<uint, double>> _parampending, _paramapply;
+    std::shared_ptr<std::mutex> _parammutex;
+
+    // Compiled model. See public member function "Set_EnableJIT".
+    // @_jitfcn: Functions of the 3 segments of the tape, or nullptr if not used.
+    // @_jitlib: Handle of the shared object, shared with clones of this simulator.
+    JitFcn _jitfcn[3];
+    std::shared_ptr<void> _jitlib;
+    std::string _jitdir;
 
     DISCRETE_VARIABLES;  // See public member function "Set_SampleTime".
     double _t;  // See public member function "Set_t" and "Get_t".
     std::vector<double> _tvec;
+    // Compressed time points, and "_tvec" is decoded from it when it's used.
+    CompressedSeries _tpacked;
+    // Time points limited by "UOutput::Set_MaxDataStorage", and "_tmax" is
+    //  their limitation, or 0 for unlimited.
+    RingBuffer _tring;
+    size_t _tmax;
+    bool _storetime;  // Whether "_tvec" is stored. See function "Update_StoreTime".
     int _divmode;  // See public member function "Set_DivergenceCheckMode".
 
     // BIT0: initialized
     // BIT1: diverged
     // BIT2: data store
-    u8 _status;
+    // BIT3: keep redundant connections
+    // BIT4: run instruction tape
+    // BIT5: own and delete modules
+    // BIT6: compile the tape by JIT
+    // BIT7: merge linear modules
+    // BIT8: optimize the graph of modules
+    // BIT9: pace simulation steps by the wall clock
+    // BIT10: compress stored time points
+    uint _status;
 };
 
 NAMESPACE_SIMUCPP_R
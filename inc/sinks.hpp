@@ -0,0 +1,133 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the class definations of output sinks, which receive
+ the data of OUTPUT modules instead of their memory storage.
+**********************/
+#ifndef SIMUCPP_SINKS_H
+#define SIMUCPP_SINKS_H
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <functional>
+#include <condition_variable>
+#include "baseclass.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Destination of data of OUTPUT modules. See "UOutput::Set_Sink()".
+"Write()" is called on the simulation thread at every stored sample,
+ "Flush()" at the end of a simulation, and "Reset()" by "Simulation_Reset()".
+**********************/
+class OutputSink
+{
+public:
+    virtual ~OutputSink() {}
+    virtual void Write(double t, double v) = 0;
+    virtual void Flush() {}
+    virtual void Reset() {}
+};
+typedef std::shared_ptr<OutputSink> PSink;
+
+
+/**********************
+Memory sink, which stores samples to vectors like OUTPUT modules do by
+ default, and can be shared by modules or kept after they are deleted.
+**********************/
+class MemorySink: public OutputSink
+{
+public:
+    virtual void Write(double t, double v) override;
+    virtual void Reset() override;
+    std::vector<double>& Get_Time();
+    std::vector<double>& Get_Data();
+private:
+    std::vector<double> _t, _v;
+};
+
+
+/**********************
+Base of sinks which consume samples on a background thread.
+Samples are written to chunks of "chunk" pairs of time and value, and a full
+ chunk is handed to the background thread, which calls "Consume()" and then
+ returns it for reuse. There are "chunks" chunks, so memory is bounded, and
+ the simulation thread only waits when all of them are full, which happens
+ when it produces data faster than they are consumed.
+**********************/
+class StreamSink: public OutputSink
+{
+public:
+    StreamSink(uint chunk=65536, uint chunks=4);
+    virtual ~StreamSink() override;
+    virtual void Write(double t, double v) override;
+    // Wait until all written samples are consumed.
+    virtual void Flush() override;
+    virtual void Reset() override;
+protected:
+    // Called on the background thread with "n" pairs of time and value.
+    virtual void Consume(const double *data, uint n) = 0;
+    // Flush and stop the background thread. Destructors of derived classes
+    //  should call it, because "Consume()" can't be called after them. If they
+    //  don't, the destructor of this class still stops the thread, but drops
+    //  samples which aren't consumed with a warning.
+    void Close();
+private:
+    void Submit();
+    void Work();
+    uint _size;  // Amount of pairs of a chunk
+    std::vector<std::vector<double>> _chunks;
+    // @_cur: Chunk being written by the simulation thread, and "_n" pairs in it.
+    // @_full: Chunks handed to the background thread, and their amounts of pairs.
+    // @_free: Chunks which can be written.
+    // @_busy: Whether the background thread is consuming a chunk.
+    // @_drop: Whether the background thread quits without consuming "_full".
+    uint _cur, _n;
+    std::deque<std::pair<uint, uint>> _full;
+    std::vector<uint> _free;
+    bool _busy, _quit, _drop;
+    std::mutex _mtx;
+    std::condition_variable _cvwork, _cvdone;
+    std::thread _thread;
+};
+
+
+/**********************
+File sink, which writes pairs of time and value as native doubles to a binary
+ file. The file is rewritten by every "Simulation_Reset()".
+Chunks are written to the buffer of the file, which is flushed by "Flush()"
+ at the end of a simulation and closed by the destructor.
+**********************/
+class FileSink: public StreamSink
+{
+public:
+    FileSink(std::string filename, uint chunk=65536, uint chunks=4);
+    virtual ~FileSink() override;
+    virtual void Flush() override;
+    virtual void Reset() override;
+protected:
+    virtual void Consume(const double *data, uint n) override;
+private:
+    std::string _filename;
+    FILE *_file;
+};
+
+
+/**********************
+Callback sink, which calls "function(data, n)" on the background thread
+ with "n" pairs of time and value.
+**********************/
+class CallbackSink: public StreamSink
+{
+public:
+    CallbackSink(std::function<void(const double*, uint)> function, uint chunk=65536, uint chunks=4);
+    virtual ~CallbackSink() override;
+protected:
+    virtual void Consume(const double *data, uint n) override;
+private:
+    std::function<void(const double*, uint)> _f;
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // SIMUCPP_SINKS_H
@@ -0,0 +1,306 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the header-only class StaticModel, which simulates a model
+ whose topology is fixed at compile time, and its static blocks.
+A model is a list of blocks, and every block refers to its inputs by their
+ indexes in the list, for example:
+    typedef StaticModel<
+        SConstant,              // 0: reference
+        SSum<0, 3>,             // 1: error = reference - y
+        SGain<1>,               // 2: controller
+        SIntegrator<2>,         // 3: y
+        SZOH<3>                 // 4: sampled y
+    > Loop;
+Blocks are updated in the order of the list, so inputs of SUM, GAIN and ZOH
+ blocks must be in front of them, except INTEGRATOR, UNITDELAY and CONSTANT
+ blocks whose outputs don't depend on their inputs in a stage. There are no
+ virtual calls and heap allocations, so the compiler can inline a whole
+ simulation step. Its numerics are identical to "Simulator::Simulate_OneStep()"
+ with the RK4 solver, while outputs of SUM and GAIN blocks after a step are
+ those of its last stage.
+**********************/
+#ifndef SIMUCPP_STATICMODEL_H
+#define SIMUCPP_STATICMODEL_H
+#include <tuple>
+#include <limits>
+#include <type_traits>
+#include "baseclass.hpp"
+#ifndef SIMUCPP_DBL_EPSILON
+#define SIMUCPP_DBL_EPSILON                  1e-6
+#endif
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Base of static blocks, whose member functions do nothing.
+Every member function is called with the index "I" of the block and the
+ model type "M", and "v" is the outputs of all blocks of the model.
+**********************/
+struct SBlock
+{
+    // Whether the output doesn't depend on inputs in a stage.
+    static const bool source = false;
+    template<int I, class M> void Reset(double */*v*/) {}
+    // Enable the block at its sample hits before the first stage of a step.
+    template<int I, class M> void Schedule(double /*t*/, double */*v*/) {}
+    // Update the output in a stage.
+    template<int I, class M> void Update(double */*v*/) {}
+    // Update the state of UNITDELAY blocks after the first stage of a step.
+    template<int I, class M> void Delay_Update(const double */*v*/) {}
+    void Clear() {}
+    // RK4 steps of INTEGRATOR blocks.
+    template<int I, class M> void Save(const double */*v*/, double */*ref*/) {}
+    template<int I, class M> void Derivative(const double */*v*/, double */*dx*/) {}
+    template<int I, class M> void Advance(double */*v*/, const double */*ref*/, const double */*k*/, double /*h*/) {}
+    template<int I, class M> void Combine(double */*v*/, const double */*ref*/, double *const */*k*/, double /*H*/) {}
+};
+
+/**********************
+Base of discrete blocks, which are enabled at their sample hits like the event
+ calendar of Simulator. A block whose sample time isn't positive is updated
+ in every stage.
+**********************/
+struct SDiscrete: public SBlock
+{
+    SDiscrete(): _T(1), _hit(0), _due(true) {}
+    void Set_SampleTime(double time=-1) { _T=time; }
+    void Clear() { if (_T > 0) _due = false; }
+    double _T, _hit;
+    bool _due;
+protected:
+    // Return true if the block gets its first sample hit of this step.
+    bool Hit(double t) {
+        bool first = false;
+        if (_T <= 0) return false;
+        while (_hit <= t+SIMUCPP_DBL_EPSILON) {
+            if (!_due) _due = first = true;
+            _hit += _T;
+        }
+        return first;
+    }
+    void Restart() { _hit = 0; _due = _T <= 0; }
+};
+
+/**********************
+CONSTANT block, which is also an input port of a model.
+**********************/
+struct SConstant: public SBlock
+{
+    static const bool source = true;
+    SConstant(double value=0): _value(value) {}
+    void Set_OutValue(double v) { _value=v; }
+    template<int I, class M> void Reset(double *v) { v[I] = _value; }
+    template<int I, class M> void Update(double *v) { v[I] = _value; }
+    double _value;
+};
+
+/**********************
+SUM block, whose inputs are the blocks "In...".
+Gains of inputs are 1 by default.
+**********************/
+template<int... In>
+struct SSum: public SBlock
+{
+    static const int N = sizeof...(In);
+    static_assert(N > 0, "SSum: A SUM block needs at least one input.");
+    SSum() { for (int i=0; i<N; ++i) _ingain[i] = 1; }
+    void Set_InputGain(double inputgain, int port=-1) { _ingain[port<0 ? N-1 : port] = inputgain; }
+    template<int I, class M> void Update(double *v) {
+        static_assert(M::template Ordered<I, In...>::value, "SSum: Inputs must be in front of the block or be sources.");
+        const int in[] = {In...};
+        double ans = 0;
+        for (int i=N-1; i>=0; --i)
+            ans += _ingain[i] * v[in[i]];
+        v[I] = ans;
+    }
+    double _ingain[N];
+};
+
+/**********************
+GAIN block.
+**********************/
+template<int In>
+struct SGain: public SBlock
+{
+    SGain(double gain=1): _gain(gain) {}
+    void Set_Gain(double gain) { _gain=gain; }
+    template<int I, class M> void Update(double *v) {
+        static_assert(M::template Ordered<I, In>::value, "SGain: Input must be in front of the block or be a source.");
+        v[I] = _gain * v[In];
+    }
+    double _gain;
+};
+
+/**********************
+INTEGRATOR block.
+**********************/
+template<int In>
+struct SIntegrator: public SBlock
+{
+    static const bool source = true;
+    SIntegrator(double value=0): _iv(value) {}
+    void Set_InitialValue(double value) { _iv=value; }
+    template<int I, class M> void Reset(double *v) { v[I] = _iv; }
+    template<int I, class M> void Save(const double *v, double *ref) { ref[I] = v[I]; }
+    template<int I, class M> void Derivative(const double *v, double *dx) { dx[I] = v[In]; }
+    template<int I, class M> void Advance(double *v, const double *ref, const double *k, double h) {
+        v[I] = ref[I] + h*k[I];
+    }
+    template<int I, class M> void Combine(double *v, const double *ref, double *const *k, double H) {
+        v[I] = ref[I] + H/3*(k[0][I] + k[1][I] + k[1][I] + k[2][I] + k[2][I] + k[3][I]);
+    }
+    double _iv;
+};
+
+/**********************
+UNITDELAY block.
+**********************/
+template<int In>
+struct SUnitDelay: public SDiscrete
+{
+    static const bool source = true;
+    SUnitDelay(double value=0): _iv(value), _lv(value) {}
+    void Set_InitialValue(double value) { _iv=_lv=value; }
+    template<int I, class M> void Reset(double *v) { v[I] = _lv = _iv; Restart(); }
+    template<int I, class M> void Schedule(double t, double *v) { if (Hit(t)) v[I] = _lv; }
+    template<int I, class M> void Delay_Update(const double *v) { if (_due) _lv = v[In]; }
+    double _iv, _lv;
+};
+
+/**********************
+ZOH block.
+**********************/
+template<int In>
+struct SZOH: public SDiscrete
+{
+    template<int I, class M> void Reset(double *v) { v[I] = 0; Restart(); }
+    template<int I, class M> void Schedule(double t, double */*v*/) { Hit(t); }
+    template<int I, class M> void Update(double *v) {
+        static_assert(M::template Ordered<I, In>::value, "SZOH: Input must be in front of the block or be a source.");
+        if (_due) v[I] = v[In];
+    }
+};
+
+
+/**********************
+Model of static blocks, see the file descriptions.
+**********************/
+template<class... Blocks>
+class StaticModel
+{
+public:
+    static const int N = sizeof...(Blocks);
+    typedef std::tuple<Blocks...> BlockList;
+    template<int I> using Block = typename std::tuple_element<I, BlockList>::type;
+
+    // Whether the inputs "In..." of the "I"th block are updated before it.
+    template<int I, int... In> struct Ordered: std::true_type {};
+    template<int I, int J, int... In> struct Ordered<I, J, In...>: std::integral_constant<bool,
+        (J>=0) && (J<N) && ((J<I) || Block<(J<N ? J : 0)>::source) && Ordered<I, In...>::value> {};
+
+    StaticModel(double endtime=10, double step=0.001): _endtime(endtime), _H(0.5*step) {
+        for (int i=0; i<4; ++i) _k[i] = _kbuf[i];
+        Simulation_Reset();
+    }
+
+    // Return the "I"th block to set its parameters.
+    template<int I> Block<I>& Get_Block() { return std::get<I>(_blocks); }
+    template<int I> double Get_OutValue() const { return _v[I]; }
+    // Outputs of all blocks, subscript index is the index of blocks.
+    const double* Get_OutValues() const { return _v; }
+    double Get_t() const { return _t; }
+    void Set_SimStep(double step=0.001) { _H=0.5*step; }
+    double Get_SimStep() const { return _H+_H; }
+    void Set_Endtime(double time) { _endtime=time; }
+    double Get_Endtime() const { return _endtime; }
+
+    // Reset all blocks to their initial state.
+    void Simulation_Reset() {
+        _t = 0;
+        for (int i=0; i<N; ++i) _v[i] = 0;
+        Each(OpReset());
+    }
+    void Simulate() {
+        while (_t < _endtime-SIMUCPP_DBL_EPSILON) Simulate_OneStep();
+        Simulate_FinalStep();
+    }
+    void Simulate_FinalStep() {
+        Each(OpSchedule(_t));
+        Stage(_k[0]);
+        Each(OpDelay());
+        Each(OpClear());
+    }
+    void Simulate_OneStep() {
+        Each(OpSchedule(_t));
+        Each(OpSave(_ref));
+        Stage(_k[0]);
+        Each(OpDelay());
+        Each(OpClear());
+
+        _t += _H;
+        Each(OpAdvance(_ref, _k[0], _H));
+        Stage(_k[1]);
+        Each(OpAdvance(_ref, _k[1], _H));
+        Stage(_k[2]);
+
+        _t += _H;
+        Each(OpAdvance(_ref, _k[2], _H+_H));
+        Stage(_k[3]);
+        Each(OpCombine(_ref, _k, _H));
+    }
+
+private:
+    // Operations applied to every blocks by "Each".
+    struct OpReset { template<int I, class B> void Run(B &b, double *v) { b.template Reset<I, StaticModel>(v); } };
+    struct OpUpdate { template<int I, class B> void Run(B &b, double *v) { b.template Update<I, StaticModel>(v); } };
+    struct OpDelay { template<int I, class B> void Run(B &b, double *v) { b.template Delay_Update<I, StaticModel>(v); } };
+    struct OpClear { template<int I, class B> void Run(B &b, double */*v*/) { b.Clear(); } };
+    struct OpSchedule {
+        double t;
+        explicit OpSchedule(double t): t(t) {}
+        template<int I, class B> void Run(B &b, double *v) { b.template Schedule<I, StaticModel>(t, v); }
+    };
+    struct OpSave {
+        double *ref;
+        explicit OpSave(double *ref): ref(ref) {}
+        template<int I, class B> void Run(B &b, double *v) { b.template Save<I, StaticModel>(v, ref); }
+    };
+    struct OpDerivative {
+        double *dx;
+        explicit OpDerivative(double *dx): dx(dx) {}
+        template<int I, class B> void Run(B &b, double *v) { b.template Derivative<I, StaticModel>(v, dx); }
+    };
+    struct OpAdvance {
+        const double *ref, *k; double h;
+        OpAdvance(const double *ref, const double *k, double h): ref(ref), k(k), h(h) {}
+        template<int I, class B> void Run(B &b, double *v) { b.template Advance<I, StaticModel>(v, ref, k, h); }
+    };
+    struct OpCombine {
+        const double *ref; double *const *k; double H;
+        OpCombine(const double *ref, double *const *k, double H): ref(ref), k(k), H(H) {}
+        template<int I, class B> void Run(B &b, double *v) { b.template Combine<I, StaticModel>(v, ref, k, H); }
+    };
+
+    template<class Op> void Each(Op op) { Each(op, std::integral_constant<int, 0>()); }
+    template<class Op, int I> void Each(Op &op, std::integral_constant<int, I>) {
+        op.template Run<I>(std::get<I>(_blocks), _v);
+        Each(op, std::integral_constant<int, I+1>());
+    }
+    template<class Op> void Each(Op &/*op*/, std::integral_constant<int, N>) {}
+
+    // Update all blocks and evaluate derivatives of INTEGRATOR blocks.
+    void Stage(double *dx) {
+        Each(OpUpdate());
+        Each(OpDerivative(dx));
+    }
+
+    BlockList _blocks;
+    double _v[N];
+    // States at the beginning of a step and slopes of RK4, only the
+    //  elements of INTEGRATOR blocks are used.
+    double _ref[N], _kbuf[4][N];
+    double *_k[4];
+    double _t, _endtime, _H;
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // SIMUCPP_STATICMODEL_H
@@ -0,0 +1,69 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the class defination of TraceReader, which reads trace
+ files saved by "Simulator::Save_Trace()".
+**********************/
+#ifndef SIMUCPP_TRACE_H
+#define SIMUCPP_TRACE_H
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "traceview.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Layout of a trace file. All integers and doubles are in native byte order.
+ TraceHead
+ TraceColumn[columns], where column 0 is the time and others are OUTPUT modules
+ Names of columns, "namelen" bytes each without terminators
+ Padding to a multiple of 8 bytes
+ Data of columns, and column n has "length" doubles from byte "offset"
+**********************/
+struct TraceHead {
+    uint32_t magic, version, columns, reserved;
+};
+struct TraceColumn {
+    uint64_t length, offset;
+    double sampletime;  // -1 represents that data is stored in every time points.
+    uint32_t namelen, reserved;
+};
+
+/**********************
+Reader of a trace file, which maps the file to memory, so opening it doesn't
+ read data, and views of columns point into the mapping and are valid until
+ the reader is destroyed. On platforms without "mmap()" the file is read to
+ memory instead.
+**********************/
+class TraceReader
+{
+public:
+    TraceReader(std::string filename);
+    ~TraceReader();
+    // Whether the file is mapped and its header is valid.
+    bool Is_Open() const;
+    // Amount of stored OUTPUT modules.
+    uint Get_Count() const;
+    // Name, sample time and data of OUTPUT module "n".
+    std::string Get_Name(uint n) const;
+    double Get_SampleTime(uint n) const;
+    TraceView Get_Signal(uint n) const;
+    // Data of the OUTPUT module named "name", which is empty if it's not found.
+    TraceView Get_Signal(std::string name) const;
+    // Index of the OUTPUT module named "name", or -1 if it's not found.
+    int Find(std::string name) const;
+    // Time points of simulation.
+    TraceView Get_Time() const;
+private:
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+    TraceView Get_Column(uint n) const;
+    void Unmap();
+    const u8 *_map;
+    size_t _size;
+    const TraceColumn *_columns;
+    std::vector<std::string> _names;  // Names of columns, including the time.
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // SIMUCPP_TRACE_H
@@ -0,0 +1,25 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the struct defination of TraceView, which is a read-only
+ view of contiguous doubles, shared by trace files and ring buffers.
+**********************/
+#ifndef SIMUCPP_TRACEVIEW_H
+#define SIMUCPP_TRACEVIEW_H
+#include <cstddef>
+#include "baseclass.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+View of "size" doubles from "data", which doesn't own them, so it's valid
+ until the storage it points into is changed or destroyed.
+**********************/
+struct TraceView {
+    const double *data;
+    size_t size;
+    double operator[](size_t n) const { return data[n]; }
+    const double* begin() const { return data; }
+    const double* end() const { return data + size; }
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // SIMUCPP_TRACEVIEW_H
@@ -8,7 +8,11 @@ The first line in code annotations of each unitmodule gives its name and abbrevi
 #ifndef BASEMODULES_H
 #define BASEMODULES_H
 #include <vector>
+#include <random>
 #include <functional>
+#include "sinks.hpp"
+#include "compress.hpp"
+#include "ringbuffer.hpp"
 #include "baseclass.hpp"
 NAMESPACE_SIMUCPP_L
 #define UNITMODULE_VIRTUAL(classname, abbrname) \
@@ -16,7 +20,6 @@ NAMESPACE_SIMUCPP_L
     public: \
         classname(Simulator *sim=nullptr, std::string name=#abbrname); \
         virtual ~classname() override; \
-        virtual double Get_OutValue() const override; \
     private: \
         virtual void Set_Enable(bool enable=false) override; \
         virtual int Self_Check() const override; \
@@ -37,8 +40,13 @@ class UConstant: public UnitModule {
     UNITMODULE_VIRTUAL(UConstant, cnst);
 public:
     void Set_OutValue(double v);
+    // Whether its value is changed by "Simulator::Set_Parameter()", so modules
+    //  reading it aren't folded by optimization. It must be set before
+    //  initialization, because handles are got after it.
+    void Set_Tunable(bool tunable=true);
 private:
-    double _outvalue;
+    // @_folded: Whether modules reading it are folded by optimization.
+    bool _tunable=false, _folded=false;
 };
 
 
@@ -50,7 +58,6 @@ class UFcn: public UnitModule {
 public:
     void Set_Function(std::function<double(double)> function);
 private:
-    double _outvalue;
     std::function<double(double)> _f=nullptr;
     PUnitModule _next=nullptr;
 };
@@ -68,7 +75,6 @@ public:
 private:
     void connect2(const PUnitModule m, uint n=0);
     void disconnect(uint n=0);
-    double _outvalue;
     std::function<double(double*)> _f=nullptr;
     std::vector<PUnitModule> _next;
 };
@@ -83,7 +89,7 @@ public:
     // Set the gain value.
     void Set_Gain(double gain);
 private:
-    double _outvalue, _gain;
+    double _gain;
     PUnitModule _next;
 };
 
@@ -107,7 +113,6 @@ public:
     // It's useless in continuous mode.
     void Set_SampleTime(double time=-1);
 private:
-    double _outvalue;
     int _cnt;  // samples count. Only used when in discrete mode
     double _T;  // Sample time. Only used when in discrete mode
     bool _isc;  // Be in continuous mode when it's true
@@ -124,7 +129,7 @@ class UIntegrator: public UnitModule {
 public:
     void Set_InitialValue(double value=0);
 private:
-    double _outvalue, _iv;
+    double _iv;
     PUnitModule _next;
 };
 
@@ -144,10 +149,14 @@ public:
     // How much does it generate a value. Default -1 represents that it generates values
     //  in every sample points.
     void Set_SampleTime(double time=-1);
+    // Set the seed of its own random number generator, which is reseeded in every
+    //  "Simulation_Reset()". Default is the order in which it's added to the simulator.
+    void Set_Seed(uint seed);
 private:
-    DISCRETE_VARIABLES;
-    double _outvalue;
+    double _T;  // Sample time
     double _mean, _var;
+    uint _seed;
+    std::mt19937 _rng;
 };
 
 
@@ -157,8 +166,10 @@ OUTPUT module.(out)
 class UOutput: public UnitModule {
     UNITMODULE_VIRTUAL(UOutput, out);
 public:
-    // Return all the stored data.
+    // Return all the stored data, which are decoded to memory if they are compressed.
     std::vector<double>& Get_StoredData();
+    // Return the compressed data. See "Set_EnableCompress".
+    const CompressedSeries& Get_CompressedData();
 
     // How long should this module collect a sample data.
     // All samples will be collected by default.
@@ -173,10 +184,28 @@ public:
     // Set the maximum amount of data it can hold.
     // -1 for don't set a limitation.
     // If too many data was stored, then earliest data will be removed.
+    // Limited data are stored in a ring buffer allocated here, and time points
+    //  of the simulator are limited by the largest limitation of its OUTPUT
+    //  modules from next initialization or "Simulation_Reset()".
     void Set_MaxDataStorage(int n=-1);
+    // Return the limited data. See "Set_MaxDataStorage".
+    const RingBuffer& Get_RingData();
+
+    // Write samples and their time to "sink" instead of storing them to memory,
+    //  and nullptr for memory storage. The sink is flushed at the end of a
+    //  simulation and reset by "Simulation_Reset()". In ensemble mode, it only
+    //  receives lane 0. Copies of this module made by "Simulator::Clone()"
+    //  don't have the sink, and they store data to memory instead.
+    void Set_Sink(PSink sink=nullptr);
+
+    // Whether to compress data stored in memory by "CompressedSeries" in delta
+    //  mode, which is lossless, so constant and evenly changing signals cost
+    //  1 or 2 bits per sample, but others still cost most of their 64 bits.
+    // It should be set before simulation, because stored data aren't converted.
+    void Set_EnableCompress(bool compress=true);
 
 private:
-    DISCRETE_VARIABLES;
+    double _T;  // Sample time
 
     // Stored data.
     std::vector<double> _values;
@@ -185,10 +214,15 @@ private:
     bool _store;
     // _maxstorage: How many samples will it store.
     int _maxstorage;
+    RingBuffer _ring;
+    // See public member function "Set_Sink".
+    PSink _sink;
+    // See public member function "Set_EnableCompress".
+    bool _compress;
+    CompressedSeries _packed;
 
-    // @_outvalue: value of its latest sample point.
-    // @_ingain: See public member function "Set_InputGain".
-    double _outvalue, _ingain;
+    // See public member function "Set_InputGain".
+    double _ingain;
 
     PUnitModule _next;
 };
@@ -206,7 +240,6 @@ public:
 private:
     void connect2(const PUnitModule m, uint n=0);
     void disconnect(uint n=0);
-    double _outvalue;
     std::vector<PUnitModule> _next;
     std::vector<double> _ingain;
 };
@@ -227,7 +260,6 @@ public:
 private:
     void connect2(const PUnitModule m, uint n=0);
     void disconnect(uint n=0);
-    double _outvalue;
     std::vector<PUnitModule> _next;
     std::vector<double> _ingain;
     bool _rdnt;
@@ -242,17 +274,33 @@ class UTransportDelay: public UnitModule {
 public:
     // Set the stored value. Default 0.
     void Set_InitialValue(double value=0);
-    // Set the delay time. The default value is one sample time. It's strongly recommanded
-    //  to call this function and set a delay time before using this module.
-    // You must be aware that the value you set may not be used accurately because
-    //  computer simulation is discrete.
+    // Set the delay time. The default value is one simulation step. It's strongly
+    //  recommanded to call this function and set a delay time before using this module.
+    // Input values are stored once every simulation step, and values between them
+    //  are interpolated. See "Set_Interpolation".
     void Set_DelayTime(double time);
+    // Set a module of the same simulator whose output is the delay time, which is
+    //  limited by the maximum delay time. "nullptr" removes it. It should be set
+    //  before initialization like connections.
+    void Set_DelayInput(PUnitModule m);
+    // Set the maximum delay time, which decides the memory of this module. It's
+    //  the delay time by default, and only used with a delay input module.
+    void Set_MaxDelayTime(double time);
+    // Set how values between stored values are interpolated. See enum "DELAY_INTERP".
+    void Set_Interpolation(int interp=INTERP_LINEAR);
 private:
-    double _outvalue, _iv;
-    // delay times and previous values
-    std::vector<double> _lv;
+    // Allocate the buffer for a simulation step "step". Called by "Simulator::Initialize()".
+    // Negative delay times represent the default ones, which are decided here.
+    void Initialize(double step);
+    // The value stored "k" steps ago.
+    double Stored_Value(int k) const;
+    double _iv;
+    double _delay, _maxdelay;
+    int _interp;
+    // Previous values, and the last one is the latest one.
+    RingBuffer _lv;
     double _simstep, _nexttime;
-    PUnitModule _next;
+    PUnitModule _next, _delayin;
 };
 
 
@@ -267,9 +315,8 @@ public:
     // Set the sample time. Default 1.
     void Set_SampleTime(double time=1);
 private:
-    DISCRETE_VARIABLES;
-    void Output_Update(double time);
-    double _outvalue;
+    double _T;  // Sample time
+    void Output_Update();
     // previous value, initial value.
     double _lv, _iv;
     PUnitModule _next;
@@ -285,8 +332,7 @@ public:
     // Set the sample time. Default 1.
     void Set_SampleTime(double time);
 private:
-    DISCRETE_VARIABLES;
-    double _outvalue;
+    double _T;  // Sample time
     PUnitModule _next;
 };
 
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <thread>
+#include "batch.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+BatchRunner::BatchRunner(PSimulator proto, uint threads)
+    : _proto(proto), _factory(nullptr), _mtx(threads>0 ? threads : SIMUCPP_MAX(std::thread::hardware_concurrency(), 1u))
+{
+    CHECK_NULLPTR(proto, Simulator);
+    _threads = _mtx.size();
+    _seed = 0;
+    _time = 0;
+    _sims.assign(_threads, nullptr);
+    _queues.resize(_threads);
+}
+BatchRunner::BatchRunner(std::function<PSimulator()> factory, uint threads)
+    : _proto(nullptr), _factory(factory), _mtx(threads>0 ? threads : SIMUCPP_MAX(std::thread::hardware_concurrency(), 1u))
+{
+    if (!factory) TRACELOG(LOG_FATAL, "BatchRunner: The factory is empty!");
+    _threads = _mtx.size();
+    _seed = 0;
+    _time = 0;
+    _sims.assign(_threads, nullptr);
+    _queues.resize(_threads);
+}
+BatchRunner::~BatchRunner() {
+    for (PSimulator sim: _sims) delete sim;
+    _sims.clear();
+}
+void BatchRunner::Set_Setup(std::function<void(PSimulator, uint)> setup) { _setup=setup; }
+void BatchRunner::Set_Collect(std::function<void(PSimulator, uint)> collect) { _collect=collect; }
+void BatchRunner::Set_Seed(uint seed) { _seed=seed; }
+uint BatchRunner::Add_Output(PUOutput m) {
+    CHECK_NULLPTR(m, UOutput);
+    _outs.push_back(m);
+    return _outs.size()-1;
+}
+std::vector<double>& BatchRunner::Get_Data(uint run, uint n) {
+    if ((run >= _status.size()) || (n >= _outs.size()))
+        TRACELOG(LOG_FATAL, "BatchRunner: Data of run %d output %d is not found!", run, n);
+    return _data[run*_outs.size() + n];
+}
+int BatchRunner::Get_Status(uint run) {
+    if (run >= _status.size())
+        TRACELOG(LOG_FATAL, "BatchRunner: Run %d is not found!", run);
+    return _status[run];
+}
+double BatchRunner::Get_Time() { return _time; }
+double BatchRunner::Get_Throughput() { return _time>0 ? _status.size()/_time : 0; }
+
+
+/**********************
+Runs are divided into contiguous blocks, one block per worker. A worker takes
+ runs from the back of its own queue and steals from the front of others.
+**********************/
+void BatchRunner::Run(uint runs) {
+    _data.assign(runs*_outs.size(), std::vector<double>());
+    _status.assign(runs, 0);
+    for (uint w=0; w<_threads; ++w) {
+        _queues[w].clear();
+        for (uint i=runs*w/_threads; i<runs*(w+1)/_threads; ++i)
+            _queues[w].push_back(i);
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint w=1; w<_threads; ++w)
+        threads.push_back(std::thread(&BatchRunner::Work, this, w));
+    Work(0);
+    for (std::thread &t: threads) t.join();
+    auto t1 = std::chrono::steady_clock::now();
+    _time = std::chrono::duration<double>(t1-t0).count();
+    TRACELOG(LOG_INFO, "BatchRunner: %d runs in %g s, %g simulations per second.",
+        runs, _time, Get_Throughput());
+}
+void BatchRunner::Work(uint w) {
+    PSimulator &sim = _sims[w];
+    uint run;
+    bool found;
+    if (!sim) sim = _proto ? _proto->Clone() : _factory();
+    if (!sim) TRACELOG(LOG_FATAL, "BatchRunner: The prototype can't be cloned, use a factory instead!");
+    while (true) {
+        found = false;
+        for (uint k=0; k<_threads && !found; ++k) {
+            uint q = (w + k) % _threads;
+            std::lock_guard<std::mutex> lock(_mtx[q]);
+            if (_queues[q].empty()) continue;
+            if (k == 0) { run = _queues[q].back(); _queues[q].pop_back(); }
+            else { run = _queues[q].front(); _queues[q].pop_front(); }
+            found = true;
+        }
+        if (!found) return;
+        sim->Set_NoiseSeed(Seed_Mix(_seed, run));
+        if (_setup) _setup(sim, run);
+        sim->Simulation_Reset();
+        _status[run] = sim->Simulate();
+        for (uint n=0; n<_outs.size(); ++n)
+            _data[run*_outs.size() + n] = sim->Get_Module(_outs[n])->Get_StoredData();
+        if (_collect) _collect(sim, run);
+    }
+}
+
+NAMESPACE_SIMUCPP_R
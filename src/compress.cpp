@@ -0,0 +1,159 @@
+#include <cstring>
+#include "compress.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+static inline uint64_t Double_Bits(double v) { uint64_t b; memcpy(&b, &v, 8); return b; }
+static inline double Bits_Double(uint64_t b) { double v; memcpy(&v, &b, 8); return v; }
+static inline int Leading_Zeros(uint64_t x) { int n=0; while (!(x & (1ull<<63))) { x<<=1; ++n; } return n; }
+static inline int Trailing_Zeros(uint64_t x) { int n=0; while (!(x & 1)) { x>>=1; ++n; } return n; }
+// Read "n" bits from bit "pos" of "w", and move "pos" after them.
+static inline uint64_t Get_Bits(const uint64_t *w, size_t &pos, uint n) {
+    if (n == 0) return 0;
+    size_t i = pos >> 6;
+    uint used = pos & 63, free = 64 - used;
+    uint64_t r = (w[i] << used) >> (64 - n);
+    if (n > free) r |= w[i+1] >> (64 - (n - free));
+    pos += n;
+    return r;
+}
+
+CompressedSeries::CompressedSeries(bool delta, uint blocksize) {
+    _delta = delta;
+    _size = blocksize<2 ? 2 : blocksize;
+    Clear();
+}
+void CompressedSeries::Clear() {
+    _blocks.clear();
+    _skip = _first = 0;
+    _cacheblock = SIZE_MAX;
+    _prev = _prev2 = 0;
+    _lead = _trail = -1;
+}
+size_t CompressedSeries::Size() const {
+    if (_blocks.empty()) return 0;
+    return (_blocks.size()-1)*_size + _blocks.back().count - _skip;
+}
+size_t CompressedSeries::Get_Bytes() const {
+    size_t bytes = 0;
+    for (const Block &b: _blocks) bytes += b.words.size()*sizeof(uint64_t) + sizeof(Block);
+    return bytes;
+}
+// Write the low "n" bits of "v" to the end of "b".
+void CompressedSeries::Put(Block &b, uint64_t v, uint n) {
+    if (n == 0) return;
+    if (n < 64) v &= (1ull<<n) - 1;
+    uint used = b.nbits & 63, free = 64 - used;
+    if (used == 0) b.words.push_back(0);
+    if (n <= free) b.words.back() |= v << (free - n);
+    else {
+        b.words.back() |= v >> (n - free);
+        b.words.push_back(v << (64 - (n - free)));
+    }
+    b.nbits += n;
+}
+void CompressedSeries::Push(double v) {
+    if (_blocks.empty() || (_blocks.back().count == _size)) {
+        _blocks.push_back(Block{std::vector<uint64_t>(), 0, 0});
+        Block &b = _blocks.back();
+        Put(b, Double_Bits(v), 64);
+        b.count = 1;
+        _prev = v;
+        _lead = _trail = -1;
+        return;
+    }
+    Block &b = _blocks.back();
+    double pred = (_delta && (b.count >= 2)) ? _prev + (_prev - _prev2) : _prev;
+    uint64_t x = Double_Bits(v) ^ Double_Bits(pred);
+    if (x == 0) Put(b, 0, 1);
+    else {
+        int lead = SIMUCPP_MIN(Leading_Zeros(x), 31), trail = Trailing_Zeros(x);
+        if ((_lead >= 0) && (lead >= _lead) && (trail >= _trail)) {
+            Put(b, 2, 2);
+            Put(b, x >> _trail, 64 - _lead - _trail);
+        }
+        else {
+            int len = 64 - lead - trail;
+            Put(b, 3, 2);
+            Put(b, lead, 5);
+            Put(b, len & 63, 6);
+            Put(b, x >> trail, len);
+            _lead = lead; _trail = trail;
+        }
+    }
+    b.count++;
+    _prev2 = _prev;
+    _prev = v;
+}
+void CompressedSeries::Drop_Front(size_t n) {
+    _skip += n;
+    while (!_blocks.empty() && (_skip >= _blocks.front().count)) {
+        _skip -= _blocks.front().count;
+        _blocks.pop_front();
+        _first++;
+    }
+    if (_blocks.empty()) Clear();
+}
+
+uint CompressedSeries::Decode_Block(size_t n, double *out) const {
+    const Block &b = _blocks[n];
+    const uint64_t *w = b.words.data();
+    size_t pos = 0;
+    int lead = 0, trail = 0;
+    out[0] = Bits_Double(Get_Bits(w, pos, 64));
+    for (uint k=1; k<b.count; ++k) {
+        double pred = (_delta && (k >= 2)) ? out[k-1] + (out[k-1] - out[k-2]) : out[k-1];
+        uint64_t x = 0;
+        if (Get_Bits(w, pos, 1)) {
+            if (Get_Bits(w, pos, 1)) {
+                lead = Get_Bits(w, pos, 5);
+                int len = Get_Bits(w, pos, 6);
+                if (len == 0) len = 64;
+                trail = 64 - lead - len;
+            }
+            x = Get_Bits(w, pos, 64 - lead - trail) << trail;
+        }
+        out[k] = Bits_Double(Double_Bits(pred) ^ x);
+    }
+    return b.count;
+}
+double CompressedSeries::At(size_t n) const {
+    n += _skip;
+    size_t block = n / _size;
+    // The last block may have grown since it was decoded.
+    if ((_first + block != _cacheblock) || (_blocks[block].count != _cachecount)) {
+        _cache.resize(_size);
+        _cachecount = Decode_Block(block, _cache.data());
+        _cacheblock = _first + block;
+    }
+    return _cache[n % _size];
+}
+void CompressedSeries::Decode(std::vector<double> &out) const {
+    out.resize(Size());
+    if (out.empty()) return;
+    std::vector<double> buf(_size);
+    uint cnt = Decode_Block(0, buf.data());
+    std::copy(buf.begin()+_skip, buf.begin()+cnt, out.begin());
+    size_t pos = cnt - _skip;
+    for (size_t n=1; n<_blocks.size(); ++n)
+        pos += Decode_Block(n, out.data() + pos);
+}
+CompressedSeries::Iterator CompressedSeries::begin() const { return Iterator(this, 0); }
+CompressedSeries::Iterator CompressedSeries::end() const { return Iterator(this, Size()); }
+
+
+CompressedSeries::Iterator::Iterator(const CompressedSeries *s, size_t n)
+    : _s(s), _n(n), _block(SIZE_MAX) {}
+double CompressedSeries::Iterator::operator*() const {
+    size_t n = _n + _s->_skip;
+    if (n / _s->_size != _block) const_cast<Iterator*>(this)->Load();
+    return _buf[n % _s->_size];
+}
+CompressedSeries::Iterator& CompressedSeries::Iterator::operator++() { ++_n; return *this; }
+void CompressedSeries::Iterator::Load() {
+    _block = (_n + _s->_skip) / _s->_size;
+    _buf.resize(_s->_size);
+    _s->Decode_Block(_block, _buf.data());
+}
+
+NAMESPACE_SIMUCPP_R
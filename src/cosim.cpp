@@ -0,0 +1,83 @@
+#include <cstring>
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+#define CHECK_COSIM() \
+    if (!(_status & FLAG_INITIALIZED)) \
+        TRACELOG(LOG_FATAL, "Simulator: Co-simulation requires an initialized simulator!"); \
+    if (_lanes > 1) \
+        TRACELOG(LOG_FATAL, "Simulator: Co-simulation doesn't support ensemble mode!")
+
+void Simulator::Set_CoPorts(const std::vector<PUConstant> &inputs, const std::vector<PUnitModule> &outputs) {
+    if (_status & FLAG_INITIALIZED)
+        TRACELOG(LOG_FATAL, "Simulator: Co-simulation ports must be set before initialization!");
+    std::vector<u8> used(_cntM, 0);
+    _coinputs.clear();
+    _cooutputs.clear();
+    for (PUnitModule m: inputs) {
+        CHECK_NULLPTR(m, UConstant);
+        if ((m->_sim != this) || used[m->_id])
+            TRACELOG(LOG_FATAL, "Simulator: Port \"%s\" isn't in this simulator or is repeated!", m->_name.c_str());
+        used[m->_id] = 1;
+        _coinputs.push_back(m);
+    }
+    for (PUnitModule m: outputs) {
+        CHECK_NULLPTR(m, UnitModule);
+        if ((m->_sim != this) || used[m->_id])
+            TRACELOG(LOG_FATAL, "Simulator: Port \"%s\" isn't in this simulator or is repeated!", m->_name.c_str());
+        if (typeid(*m) == typeid(UIntegrator))
+            TRACELOG(LOG_FATAL, "Simulator: Port \"%s\" is an INTEGRATOR module, connect it to an OUTPUT module "
+                "and use that one instead!", m->_name.c_str());
+        used[m->_id] = 1;
+        _cooutputs.push_back(m);
+    }
+}
+double* Simulator::Get_CoInputs() {
+    CHECK_COSIM();
+    return _outvalues.data() + _cntI;
+}
+const double* Simulator::Get_CoOutputs() {
+    CHECK_COSIM();
+    return _outvalues.data() + _cntI + _coinputs.size();
+}
+void Simulator::Set_CoInputs(const double *u) {
+    memcpy(Get_CoInputs(), u, _coinputs.size()*sizeof(double));
+}
+void Simulator::Get_CoOutputs(double *y) {
+    memcpy(y, Get_CoOutputs(), _cooutputs.size()*sizeof(double));
+}
+
+/**********************
+Advance the simulation to the next communication point. Variable-step
+ solvers stop exactly at it, because the end time is moved to it for a while.
+After the steps, the stage and the sequence tables of OUTPUT modules are
+ evaluated at the communication point, so that output ports hold the values
+ of the current time, and it doesn't store data or update discrete modules.
+NOISE modules generating values in every step are disabled meanwhile and keep
+ their values, so the refresh doesn't draw random numbers and results are the
+ same as those of "Simulate_OneStep()".
+**********************/
+int Simulator::DoStep(double commstep) {
+    CHECK_COSIM();
+    int err = 0;
+    double endtime = _endtime;
+    _endtime = _t + commstep;
+    while (_t < _endtime-SIMUCPP_DBL_EPSILON) {
+        err = Simulate_OneStep();
+        if (err) break;
+    }
+    _endtime = endtime;
+    if (err) return err;
+    for (uint id: _noiseIDs) _modules[id]->_enable = false;
+    Stage_Update(_odeK[0]);
+    for (auto &ids: _outIDs)
+        for (int j=ids.size()-1; j>0; --j)
+            Update_Module(ids[j]);
+    for (uint id: _noiseIDs) _modules[id]->_enable = true;
+    for (PUOutput m: _outputs)
+        if (m->_enable && (m->_T <= 0)) *m->_outvalue = m->_ingain * m->_next->Get_OutValue();
+    return 0;
+}
+
+NAMESPACE_SIMUCPP_R
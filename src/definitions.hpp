@@ -18,6 +18,49 @@ global
 #define SIMUCPP_INFINITE1                    1e16
 // Used to solve the problem of imprecision of floating-point numbers
 #define SIMUCPP_DBL_EPSILON                  1e-6
+// Minimum step of variable-step solvers
+#define SIMUCPP_RK45_MINSTEP                 1e-12
+// Newton iterations of implicit solvers
+#define SIMUCPP_NEWTON_MAXITER               4
+#define SIMUCPP_NEWTON_TOL                   1e-2
+// Newton iterations of algebraic loops
+#define SIMUCPP_LOOP_MAXITER                 20
+#define SIMUCPP_LOOP_TOL                     1e-10
+// Relative perturbation of finite-difference Jacobian
+#define SIMUCPP_JACOBIAN_DELTA               1e-8
+// Busy-wait iterations of worker threads before yielding or sleeping
+#define SIMUCPP_THREAD_SPIN                  (1<<14)
+// Least fill ratio of a linear block to be stored as a dense matrix
+#define SIMUCPP_LINEAR_DENSE                 0.25
+// Instructions in a function of the source generated by JIT
+#define SIMUCPP_JIT_CHUNK                    256
+// First word of state blobs, "SIMS"
+#define SIMUCPP_STATE_MAGIC                  0x534D4953
+// First word of trace files, "SIMT", and version of their layout
+#define SIMUCPP_TRACE_MAGIC                  0x544D4953
+#define SIMUCPP_TRACE_VERSION                1
+// Latency histogram of real-time steps: bins per decade, decades and least latency
+#define SIMUCPP_RT_DECADE_BINS               100
+#define SIMUCPP_RT_DECADES                   9
+#define SIMUCPP_RT_MIN_LATENCY               1e-7
+
+
+// Mix a seed with an index to get independent seeds of random numbers.
+inline unsigned int Seed_Mix(unsigned int seed, unsigned int n) {
+    unsigned long long z = ((unsigned long long)seed << 32) + n + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (unsigned int)(z ^ (z >> 31));
+}
+
+
+NAMESPACE_SIMUCPP_L
+// LU decomposition with partial pivoting of a n*n matrix "a" in place.
+// Return false if "a" is singular. See "solver.cpp".
+bool LU_Decompose(double *a, int *piv, int n);
+// Solve "ax=b" in place by the result of "LU_Decompose".
+void LU_Solve(const double *a, const int *piv, int n, double *b);
+NAMESPACE_SIMUCPP_R
 
 
 /**********************
@@ -49,39 +92,63 @@ enum SIMUCPP_ERROR_CODE{
 #define DISCRETE_INITIALIZE(x) \
     _T = x; \
     _ltn = -_T
-#define DISCRETE_UPDATE() \
-    if (time-_ltn<_T-SIMUCPP_DBL_EPSILON) return; \
-    _ltn += _T
 
 
 /**********************
 simulator.cpp
 **********************/
-#define MODULE_INTEGRATOR_UPDATE() \
-    for(int i=0; i<_cntI; ++i)  for (int j=_integIDs[i].size()-1; j>0; --j) \
-        _modules[_integIDs[i][j]]->Module_Update(_t)
+enum SIMULATOR_FLAG {
+    FLAG_INITIALIZED  = 0x01,   // Set when the simulator is initialized
+    FLAG_DIVERGED     = 0x02,   // Set when the simulation diverged
+    FLAG_STORE        = 0x04,   // Set to store simulation data to memory
+    FLAG_REDUNDANT    = 0x08,   // Clear to delete redundant modules
+    FLAG_TAPE         = 0x10,   // Set to run instruction tape
+    FLAG_OWNER        = 0x20,   // Set when modules are deleted with the simulator
+    FLAG_JIT          = 0x40,   // Set to compile the tape by JIT
+    FLAG_LINEAR       = 0x80,   // Set to merge linear modules of the tape
+    FLAG_OPTIMIZE     = 0x100,  // Set to optimize the graph of modules
+    FLAG_REALTIME     = 0x200,  // Set to pace simulation steps by the wall clock
+    FLAG_COMPRESS     = 0x400,  // Set to compress stored time points
+};
+
 #define MODULE_OUTPUT_UPDATE() \
-    for(int i=0; i<_cntO; ++i)  for (int j=_outIDs[i].size()-1; j>=0; --j) \
-        _modules[_outIDs[i][j]]->Module_Update(_t)
+    if ((_status & FLAG_TAPE) && _jitfcn[2]) _jitfcn[2](_outvalues.data(), nullptr, this, Jit_Update, Jit_Fcn); \
+    else if (_status & FLAG_TAPE) Run_Tape(_tapeseg[2], _tapeseg[3], _tapebuf.data()); \
+    else for(uint i=0; i<_cntO; ++i)  for (int j=_outIDs[i].size()-1; j>=0; --j) \
+        Update_Module(_outIDs[i][j])
 #define MODULE_UNITDELAY_UPDATE() \
-    for(int i=0; i<_cntD; ++i)  for (int j=_delayIDs[i].size()-1; j>=0; --j) \
-        _modules[_delayIDs[i][j]]->Module_Update(_t)
-#define MODULE_UNITDELAY_UPDATE_OUTPUT() \
-    for(int i=0; i<_cntD; ++i) _unitdelays[i]->Output_Update(_t)
+    if ((_status & FLAG_TAPE) && _jitfcn[1]) _jitfcn[1](_outvalues.data(), nullptr, this, Jit_Update, Jit_Fcn); \
+    else if (_status & FLAG_TAPE) Run_Tape(_tapeseg[1], _tapeseg[2], _tapebuf.data()); \
+    else for(uint i=0; i<_cntD; ++i)  for (int j=_delayIDs[i].size()-1; j>=0; --j) \
+        Update_Module(_delayIDs[i][j])
 #define CHECK_NULLPTR(x, type) \
     if (x==nullptr) TRACELOG(LOG_FATAL, #type": Module "#x" is a null pointer!")
 #define CHECK_NULLID(x, type) \
     if (x->_id==-1) TRACELOG(LOG_FATAL, #type": Module \"%s\" is not added to a simulator!", x->_name.c_str())
 #define CHECK_SIMULATOR(x, type) \
     if (x->_sim!=this) TRACELOG(LOG_FATAL, #type": Module \"%s\" is added to a wrong simulator!", x->_name.c_str())
-#define SET_DISCRETE_ENABLE(x) \
-    for (int i: _discIDs) \
-        _modules[i]->Set_Enable(x)
+#define CLONE_MODULE(type) \
+    if (typeid(*m) == typeid(type)) return new type(*(type*)m)
+#define CLONE_CHILD(type) \
+    if (typeid(*m) == typeid(type)) { \
+        type *mdl = (type*)m; \
+        if (mdl->_next) mdl->_next = modules[mdl->_next->_id]; }
+#define CLONE_CHILDREN(type) \
+    if (typeid(*m) == typeid(type)) { \
+        type *mdl = (type*)m; \
+        for (PUnitModule &bm: mdl->_next) bm = modules[bm->_id]; }
+#define CHILD_SLOT(type) \
+    if (typeid(*m) == typeid(type)) return n==0 ? &((type*)m)->_next : nullptr
+#define CHILD_SLOTS(type) \
+    if (typeid(*m) == typeid(type)) return n<((type*)m)->_next.size() ? &((type*)m)->_next[n] : nullptr
+#define CHECK_LANE(x) \
+    if (!(_status & FLAG_INITIALIZED) || (_lanes<2) || ((x)>=_lanes)) \
+        TRACELOG(LOG_FATAL, "Simulator: Lane %d is not available before initialization in ensemble mode!", (int)(x))
 #define CHECK_CONVERGENCE(x, y) \
     for (x m: y) { \
-        if (m->_outvalue > SIMUCPP_INFINITE1) return 1; \
-        if (m->_outvalue < -SIMUCPP_INFINITE1) return 2; \
-        if (std::isnan(m->_outvalue)) return 3; \
+        if (*m->_outvalue > SIMUCPP_INFINITE1) return 1; \
+        if (*m->_outvalue < -SIMUCPP_INFINITE1) return 2; \
+        if (std::isnan(*m->_outvalue)) return 3; \
     }
 #define PRINT_CONVERGENCE(x) \
     switch (x) { \
@@ -0,0 +1,221 @@
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Ensemble mode.
+Every slot of "_outvalues" is widened to "_lanes" contiguous values, and lane
+ "l" of module "id" is "_outvalues[id*_lanes+l]". Lane 0 is the slot which the
+ module itself reads and writes, so modules whose outputs only depend on time
+ are updated once and copied to other lanes. INTEGRATOR modules are the first
+ "_cntI" modules, so their lanes are still a contiguous state vector of length
+ "_cntX" and every solver integrates all lanes together.
+Only arithmetic modules, INPUT, NOISE and OUTPUT modules are supported, because
+ other modules keep their own states which are not widened.
+**********************/
+void Simulator::Build_Lanes() {
+    const uint L = _lanes;
+    PUnitModule m;
+    for (const TapeCode &code: _tape) {
+        if (code.op == TAPE_LOOP)
+            TRACELOG(LOG_FATAL, "Simucpp: Algebraic loops don't support ensemble mode!");
+        if ((code.op != TAPE_UPDATE) && (code.op != TAPE_DISCRETE)) continue;
+        m = code.m;
+        if (typeid(*m) == typeid(UInput)) continue;
+        if (typeid(*m) == typeid(UNoise)) continue;
+        if (typeid(*m) == typeid(UOutput)) continue;
+        TRACELOG(LOG_FATAL, "Simucpp: Module \"%s\" doesn't support ensemble mode!", m->_name.c_str());
+    }
+    _lanegains.resize(_tapegains.size() * L);
+    for (uint k=0; k<_tapegains.size(); ++k)
+        for (uint l=0; l<L; ++l)
+            _lanegains[k*L+l] = _tapegains[k];
+    _lanearg.assign(_cntM, -1);
+    for (const TapeCode &code: _tape)
+        _lanearg[code.dst] = code.arg;
+    _laneinit.resize(_cntX);
+    for (uint i=0; i<_cntI; ++i)
+        for (uint l=0; l<L; ++l)
+            _laneinit[i*L+l] = _integrators[i]->_iv;
+    _laneout.assign(_cntM, 0);
+    for (uint i=0; i<_cntO; ++i)
+        _laneout[_outputs[i]->_id] = i;
+    _lanedata.assign(_cntO*(L-1), std::vector<double>());
+    _lanering.assign(_cntO*(L-1), RingBuffer());
+    _lanepacked.assign(_cntO*(L-1), CompressedSeries(true));
+    if (_laneseed.size() < L) {
+        for (uint l=_laneseed.size(); l<L; ++l) _laneseed.push_back(l);
+    }
+    _lanenoise.assign(_cntM, 0);
+    uint cnt = 0;
+    for (PUnitModule m: _modules)
+        if ((m != nullptr) && (typeid(*m) == typeid(UNoise))) _lanenoise[m->_id] = cnt++;
+    _lanerng.resize(cnt*(L-1));
+    for (uint l=1; l<L; ++l) Seed_Lane(l);
+}
+void Simulator::Reset_Lanes() {
+    for (uint i=0; i<_cntX; ++i)
+        _outvalues[i] = _laneinit[i];
+    for (auto &data: _lanedata) data.clear();
+    for (auto &ring: _lanering) ring.Clear();
+    for (auto &packed: _lanepacked) packed.Clear();
+    for (uint l=1; l<_lanes; ++l) Seed_Lane(l);
+}
+/**********************
+Every NOISE module has its own random number generator in every lane. Lane 0
+ is updated by the module itself, so it draws the same numbers as the model
+ without ensemble mode, and the generator of lane "l" is seeded by the seed
+ of the module mixed with the seed of the lane.
+**********************/
+void Simulator::Seed_Lane(uint lane) {
+    for (PUnitModule m: _modules) {
+        if ((m == nullptr) || (typeid(*m) != typeid(UNoise))) continue;
+        _lanerng[_lanenoise[m->_id]*(_lanes-1) + lane-1].seed(Seed_Mix(((UNoise*)m)->_seed, _laneseed[lane]));
+    }
+}
+
+/**********************
+Run instructions of the tape on every lanes. Loops over lanes are innermost
+ and have unit strides, so that they can be vectorized by compilers.
+**********************/
+void Simulator::Run_Lanes(uint begin, uint end, double *buf) {
+    const uint L = _lanes;
+    double *v = _outvalues.data();
+    const uint *args = _tapeargs.data();
+    const double *gains = _lanegains.data();
+    for (const TapeCode *code=_tape.data()+begin, *last=_tape.data()+end; code!=last; ++code) {
+        const uint *a = args + code->arg;
+        const double *g = gains + code->arg*L;
+        double *y = v + code->dst*L;
+        switch (code->op) {
+        case TAPE_SUM:
+            for (uint l=0; l<L; ++l) y[l] = 0;
+            for (int k=code->cnt-1; k>=0; --k) {
+                const double *u = v + a[k]*L, *gk = g + k*L;
+                for (uint l=0; l<L; ++l) y[l] += gk[l] * u[l];
+            }
+            break;
+        case TAPE_GAIN: {
+            const double *u = v + a[0]*L;
+            for (uint l=0; l<L; ++l) y[l] = g[l] * u[l];
+            break;
+        }
+        case TAPE_PRODUCT:
+            for (uint l=0; l<L; ++l) y[l] = 1;
+            for (int k=code->cnt-1; k>=0; --k) {
+                const double *u = v + a[k]*L, *gk = g + k*L;
+                for (uint l=0; l<L; ++l) y[l] *= gk[l] * u[l];
+            }
+            break;
+        case TAPE_FCN:
+            for (uint l=0; l<L; ++l)
+                y[l] = ((UFcn*)code->m)->_f(v[a[0]*L+l]);
+            break;
+        case TAPE_FCNMISO:
+            for (uint l=0; l<L; ++l) {
+                for (uint k=0; k<code->cnt; ++k)
+                    buf[k] = v[a[k]*L+l];
+                y[l] = ((UFcnMISO*)code->m)->_f(buf);
+            }
+            break;
+        case TAPE_DISCRETE:
+            if (!_due[code->dst]) break;
+            Lane_Update(code->m, y);
+            break;
+        default:
+            Lane_Update(code->m, y);
+            break;
+        }
+    }
+}
+void Simulator::Lane_Update(PUnitModule m, double *y) {
+    const uint L = _lanes;
+    if (typeid(*m) == typeid(UNoise)) {
+        UNoise *mdl = (UNoise*)m;
+        std::mt19937 *rng = _lanerng.data() + _lanenoise[m->_id]*(L-1);
+        double U, V;
+        m->Module_Update(_t);
+        if (!mdl->_enable) return;
+        for (uint l=1; l<L; ++l) {
+            U = (rng[l-1]()+1.0) / 4294967296.0;
+            V = (rng[l-1]()+1.0) / 4294967296.0;
+            y[l] = mdl->_var * sqrt(-2.0 * log(U))* cos(6.283185307179586477 * V) + mdl->_mean;
+        }
+        return;
+    }
+    m->Module_Update(_t);
+    if (typeid(*m) == typeid(UOutput)) {
+        UOutput *mdl = (UOutput*)m;
+        const double *u = _outvalues.data() + mdl->_next->_id*L;
+        std::vector<double> *data = _lanedata.data() + _laneout[m->_id]*(L-1);
+        RingBuffer *ring = _lanering.data() + _laneout[m->_id]*(L-1);
+        CompressedSeries *packed = _lanepacked.data() + _laneout[m->_id]*(L-1);
+        for (uint l=1; l<L; ++l) {
+            y[l] = mdl->_ingain * u[l];
+            if (!mdl->_store) continue;
+            if (mdl->_compress) {
+                packed[l-1].Push(y[l]);
+                if ((mdl->_maxstorage > 0) && (packed[l-1].Size() > (size_t)mdl->_maxstorage)) packed[l-1].Drop_Front(1);
+                continue;
+            }
+            if (mdl->_maxstorage <= 0) { data[l-1].push_back(y[l]); continue; }
+            if (ring[l-1].Capacity() != (size_t)mdl->_maxstorage) ring[l-1].Set_Capacity(mdl->_maxstorage);
+            ring[l-1].Push(y[l]);
+        }
+        return;
+    }
+    for (uint l=1; l<L; ++l) y[l] = y[0];
+}
+
+
+void Simulator::Set_Ensemble(uint lanes) {
+    if (_status & FLAG_INITIALIZED) {
+        TRACELOG(LOG_WARNING, "Simulator: Ensemble mode must be set before initialization.");
+        return;
+    }
+    _lanes = lanes<1 ? 1 : lanes;
+}
+uint Simulator::Get_Lanes() { return _lanes; }
+void Simulator::Set_LaneSeed(uint lane, uint seed) {
+    if (_laneseed.size() <= lane) {
+        for (uint l=_laneseed.size(); l<=lane; ++l) _laneseed.push_back(l);
+    }
+    _laneseed[lane] = seed;
+    if ((lane > 0) && (lane < _lanes) && (_status & FLAG_INITIALIZED)) Seed_Lane(lane);
+}
+void Simulator::Set_LaneGain(PUGain m, uint lane, double gain) {
+    CHECK_NULLPTR(m, UGain);
+    CHECK_LANE(lane);
+    if (_lanearg[m->_id] < 0) {
+        TRACELOG(LOG_WARNING, "Simulator: GAIN module \"%s\" isn't updated in simulation.", m->_name.c_str());
+        return;
+    }
+    int merged = Find_Merged(m, 0);
+    _lanegains[_lanearg[m->_id]*_lanes + lane] = merged<0 ? gain : gain*_merged[merged].factor;
+}
+void Simulator::Set_LaneInitialValue(PUIntegrator m, uint lane, double value) {
+    CHECK_NULLPTR(m, UIntegrator);
+    CHECK_LANE(lane);
+    _laneinit[m->_id*_lanes + lane] = value;
+    if (_t == 0) _outvalues[m->_id*_lanes + lane] = value;
+}
+void Simulator::Set_NoiseSeed(uint seed) {
+    for (PUnitModule m: _modules) {
+        if (m==nullptr) continue;
+        if (typeid(*m) == typeid(UNoise))
+            ((UNoise*)m)->Set_Seed(Seed_Mix(seed, m->_id));
+    }
+    if ((_lanes > 1) && (_status & FLAG_INITIALIZED))
+        for (uint l=1; l<_lanes; ++l) Seed_Lane(l);
+}
+std::vector<double>& Simulator::Get_LaneData(PUOutput m, uint lane) {
+    CHECK_NULLPTR(m, UOutput);
+    if (lane == 0) return m->Get_StoredData();
+    CHECK_LANE(lane);
+    uint n = _laneout[m->_id]*(_lanes-1) + lane-1;
+    if (m->_compress) _lanepacked[n].Decode(_lanedata[n]);
+    else if (m->_maxstorage > 0) _lanering[n].Copy(_lanedata[n]);
+    return _lanedata[n];
+}
+
+NAMESPACE_SIMUCPP_R
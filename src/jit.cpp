@@ -0,0 +1,245 @@
+#include <cstdio>
+#include <cerrno>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "simulator.hpp"
+#include "definitions.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SIMUCPP_JIT_SUPPORTED
+#endif
+NAMESPACE_SIMUCPP_L
+
+/**********************
+FNV-1a hash of the generated source, used as the name of compiled artifacts.
+**********************/
+static unsigned long long Jit_Hash(const std::string &src) {
+    unsigned long long h = 0xCBF29CE484222325ull;
+    for (unsigned char c: src) {
+        h ^= c;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+static void Jit_Number(std::ostringstream &os, double x) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%a", x);
+    os << '(' << buf << ')';
+}
+
+void Simulator::Jit_Update(void *sim, uint i) {
+    PSimulator s = (PSimulator)sim;
+    s->Run_Tape(i, i+1, s->_tapebuf.data());
+}
+double Simulator::Jit_Fcn(void *sim, uint i, double u) {
+    return ((UFcn*)((PSimulator)sim)->_tape[i].m)->_f(u);
+}
+
+/**********************
+Generate C++ source of the 3 segments of the instruction tape.
+Every arithmetic instruction becomes a statement on slots of "_outvalues",
+ whose gains are written in hexadecimal to be exact, and its operations are
+ in the same order as "Run_Tape()" so that results are identical. FCN
+ instructions call their functions through "Jit_Fcn", and other instructions
+ call back to "Run_Tape()" through "Jit_Update".
+Statements are divided into functions of "SIMUCPP_JIT_CHUNK" instructions,
+ because compilers optimize a huge function very slowly.
+**********************/
+std::string Simulator::Jit_Source() {
+    std::ostringstream os, body;
+    uint chunk = 0;
+    os << "// Generated by simucpp.\n";
+    os << "typedef void (*Update)(void*, unsigned);\n";
+    os << "typedef double (*Fcn)(void*, unsigned, double);\n";
+    os << "#if defined(__GNUC__)\n#define NOINLINE __attribute__((noinline))\n";
+    os << "#else\n#define NOINLINE\n#endif\n";
+    for (int seg=0; seg<3; ++seg) {
+        body.str("");
+        for (uint i=_tapeseg[seg]; i<_tapeseg[seg+1]; ++i) {
+            if ((i-_tapeseg[seg]) % SIMUCPP_JIT_CHUNK == 0) {
+                if (i > _tapeseg[seg]) os << "}\n";
+                os << "static NOINLINE void chunk" << chunk
+                   << "(double *v, void *sim, Update update, Fcn fcn) {\n";
+                body << "    chunk" << chunk << "(v, sim, update, fcn);\n";
+                chunk++;
+            }
+            const TapeCode &code = _tape[i];
+            const uint *a = _tapeargs.data() + code.arg;
+            const double *g = _tapegains.data() + code.arg;
+            switch (code.op) {
+            case TAPE_SUM:
+                os << "    v[" << code.dst << "] = 0.0";
+                for (int k=code.cnt-1; k>=0; --k) {
+                    os << " + "; Jit_Number(os, g[k]); os << "*v[" << a[k] << "]";
+                }
+                os << ";\n";
+                break;
+            case TAPE_GAIN:
+                os << "    v[" << code.dst << "] = ";
+                Jit_Number(os, g[0]); os << "*v[" << a[0] << "];\n";
+                break;
+            case TAPE_PRODUCT:
+                os << "    v[" << code.dst << "] = 1.0";
+                for (int k=code.cnt-1; k>=0; --k) {
+                    os << "*("; Jit_Number(os, g[k]); os << "*v[" << a[k] << "])";
+                }
+                os << ";\n";
+                break;
+            case TAPE_FCN:
+                os << "    v[" << code.dst << "] = fcn(sim, " << i << ", v[" << a[0] << "]);\n";
+                break;
+            default:
+                os << "    update(sim, " << i << ");\n";
+                break;
+            }
+        }
+        if (_tapeseg[seg+1] > _tapeseg[seg]) os << "}\n";
+        os << "extern \"C\" void simucpp_seg" << seg
+           << "(double *v, double *dx, void *sim, Update update, Fcn fcn) {\n" << body.str();
+        if (seg == 0) {
+            for (uint i=0; i<_cntI; ++i)
+                os << "    dx[" << i << "] = v[" << _stagederiv[i] << "];\n";
+        }
+        os << "}\n";
+    }
+    return os.str();
+}
+
+#if defined(SIMUCPP_JIT_SUPPORTED)
+/**********************
+Whether "path" is owned by this user and can't be written by others, so that
+ nobody else can plant a library in it. Symbolic links aren't followed.
+**********************/
+static bool Jit_Trusted(const std::string &path, bool dir) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0) return false;
+    if (dir ? !S_ISDIR(st.st_mode) : !S_ISREG(st.st_mode)) return false;
+    return (st.st_uid == geteuid()) && !(st.st_mode & (S_IWGRP | S_IWOTH));
+}
+// Create directory "dir" and its parents with mode 0700 if they don't exist.
+static void Jit_Mkdir(const std::string &dir) {
+    for (size_t pos=dir.find('/', 1); pos!=std::string::npos; pos=dir.find('/', pos+1))
+        mkdir(dir.substr(0, pos).c_str(), 0700);
+    mkdir(dir.c_str(), 0700);
+}
+// The per-user cache directory, "$XDG_CACHE_HOME/simucpp_jit" or "$HOME/.cache/simucpp_jit".
+static std::string Jit_CacheDir() {
+    const char *xdg = getenv("XDG_CACHE_HOME"), *home = getenv("HOME");
+    if (xdg && (xdg[0] == '/')) return std::string(xdg) + "/simucpp_jit";
+    if (home && (home[0] == '/')) return std::string(home) + "/.cache/simucpp_jit";
+    return "/tmp/simucpp_jit_" + std::to_string(geteuid());
+}
+// The compiler is given by "CXX" only if it's a plain program name or path.
+static std::string Jit_Compiler() {
+    const char *cxx = getenv("CXX");
+    if (!cxx || !cxx[0]) return "c++";
+    for (const char *c=cxx; *c; ++c) {
+        if (isalnum((unsigned char)*c) || strchr("_-+./", *c)) continue;
+        TRACELOG(LOG_WARNING, "Simulator: Environment variable CXX isn't a program name, c++ is used instead.");
+        return "c++";
+    }
+    return cxx;
+}
+// Run the compiler without a shell, and write its errors to "log".
+static bool Jit_Compile(const std::string &cxx, const std::string &src, const std::string &out, const std::string &log) {
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd >= 0) { dup2(fd, 2); close(fd); }
+        execlp(cxx.c_str(), cxx.c_str(), "-O2", "-shared", "-fPIC", "-o", out.c_str(), src.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+        if (errno != EINTR) return false;
+    return WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+#endif
+
+/**********************
+Compile the generated source with the system compiler, which is given by the
+ environment variable "CXX" or "c++" by default, and load it. The shared
+ object is named by the hash of the source in "_jitdir", so a model which has
+ been compiled is loaded directly. The directory and the library are only
+ used if they belong to this user and others can't write them.
+The tape is used if anything fails.
+**********************/
+void Simulator::Build_JIT() {
+    for (int i=0; i<3; ++i) _jitfcn[i] = nullptr;
+    if (_lanes > 1) {
+        TRACELOG(LOG_WARNING, "Simulator: JIT doesn't support ensemble mode.");
+        return;
+    }
+#if defined(SIMUCPP_JIT_SUPPORTED)
+    std::string src = Jit_Source();
+    char name[32];
+    snprintf(name, sizeof(name), "simucpp_%016llx", Jit_Hash(src));
+    std::string dir = _jitdir.empty() ? Jit_CacheDir() : _jitdir;
+    std::string base = dir + "/" + name;
+    std::string lib = base + ".so";
+    Jit_Mkdir(dir);
+    if (!Jit_Trusted(dir, true)) {
+        TRACELOG(LOG_WARNING, "Simulator: JIT directory %s isn't owned by this user or is writable by others.", dir.c_str());
+        return;
+    }
+    if (access(lib.c_str(), F_OK) != 0) {
+        // The source, the log and the library are private files of this process, and the
+        //  library is renamed when it's complete, so other processes never see partial ones.
+        std::string tmp = base + "." + std::to_string(getpid());
+        std::ofstream(tmp + ".cpp") << src;
+        TRACELOG(LOG_DEBUG, "Simucpp: JIT compiling %s.cpp", tmp.c_str());
+        bool ok = Jit_Compile(Jit_Compiler(), tmp + ".cpp", tmp + ".so", tmp + ".log")
+            && (rename((tmp + ".so").c_str(), lib.c_str()) == 0);
+        if (!ok) {
+            TRACELOG(LOG_WARNING, "Simulator: JIT compilation failed, see %s.log", tmp.c_str());
+            remove((tmp + ".so").c_str());
+            return;
+        }
+        remove((tmp + ".cpp").c_str());
+        remove((tmp + ".log").c_str());
+    }
+    if (!Jit_Trusted(lib, false)) {
+        TRACELOG(LOG_WARNING, "Simulator: JIT library %s isn't owned by this user or is writable by others.", lib.c_str());
+        return;
+    }
+    void *handle = dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        TRACELOG(LOG_WARNING, "Simulator: JIT loading failed: %s", dlerror());
+        return;
+    }
+    _jitlib = std::shared_ptr<void>(handle, [](void *h){ dlclose(h); });
+    for (int i=0; i<3; ++i) {
+        std::string sym = "simucpp_seg" + std::to_string(i);
+        _jitfcn[i] = (JitFcn)dlsym(handle, sym.c_str());
+        if (_jitfcn[i]) continue;
+        TRACELOG(LOG_WARNING, "Simulator: JIT symbol %s is not found.", sym.c_str());
+        for (int j=0; j<3; ++j) _jitfcn[j] = nullptr;
+        return;
+    }
+    TRACELOG(LOG_DEBUG, "Simucpp: JIT loaded %s", lib.c_str());
+#else
+    TRACELOG(LOG_WARNING, "Simulator: JIT is not supported on this platform.");
+#endif
+}
+
+void Simulator::Set_EnableJIT(bool jit, std::string dir) {
+    _jitdir = dir;
+    if (!jit) {
+        _status &=~ FLAG_JIT;
+        for (int i=0; i<3; ++i) _jitfcn[i] = nullptr;
+        return;
+    }
+    _status |= FLAG_JIT;
+    if (_status & FLAG_INITIALIZED) Build_JIT();
+}
+bool Simulator::Get_EnableJIT() { return _jitfcn[0] != nullptr; }
+
+NAMESPACE_SIMUCPP_R
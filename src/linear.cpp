@@ -0,0 +1,220 @@
+#include <map>
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Merge SUM and GAIN instructions of the stage schedule into linear blocks.
+The stage segment is scanned in order, and consecutive linear instructions
+ are collected into a region until an instruction which isn't linear reads
+ a value of the region, then the region is emitted as one linear block right
+ before that instruction. Every value of a region is expanded into a linear
+ combination of values computed outside the region, which are INTEGRATOR
+ modules, nonlinear modules and inputs, so the matrix of the block maps these
+ values to the values read outside the region or by derivatives of INTEGRATOR
+ modules. Other values of the region are eliminated.
+Instructions of the new stage segment are sorted by levels again, so that
+ the stage can still be divided among threads.
+**********************/
+void Simulator::Build_Linear() {
+    if (_lanes > 1) {
+        TRACELOG(LOG_WARNING, "Simulator: Linear blocks don't support ensemble mode.");
+        return;
+    }
+    const uint n = _tapeseg[1] - _tapeseg[0];
+    std::vector<int> prodreg(_cntM, -1);  // Region which produces every slots.
+    std::vector<int> codereg(_tape.size(), -1);  // Region of every instructions.
+    std::vector<std::vector<uint>> regions;
+    // New order of the stage segment, and "~r" stands for region "r".
+    std::vector<int> order;
+    std::vector<uint> reads;
+    int cur = -1;
+    for (uint i=_tapeseg[0]; i<_tapeseg[1]; ++i) {
+        const TapeCode &code = _tape[i];
+        if ((code.op == TAPE_SUM) || (code.op == TAPE_GAIN)) {
+            if (cur < 0) {
+                cur = regions.size();
+                regions.push_back(std::vector<uint>());
+            }
+            regions[cur].push_back(i);
+            codereg[i] = cur;
+            prodreg[code.dst] = cur;
+            continue;
+        }
+        reads.clear();
+        Tape_Reads(code, reads);
+        for (uint r: reads) {
+            if ((cur < 0) || (prodreg[r] != cur)) continue;
+            order.push_back(~cur);
+            cur = -1;
+            break;
+        }
+        order.push_back(i);
+    }
+    if (cur >= 0) order.push_back(~cur);
+
+    // Values needed outside their regions.
+    std::vector<u8> needed(_cntM, 0);
+    for (uint i=0; i<_tape.size(); ++i) {
+        reads.clear();
+        Tape_Reads(_tape[i], reads);
+        for (uint r: reads)
+            if ((prodreg[r] >= 0) && (codereg[i] != prodreg[r])) needed[r] = 1;
+    }
+    for (uint i=0; i<_cntI; ++i)
+        needed[_stagederiv[i]] = 1;
+
+    // Expand values of every regions and build their linear blocks.
+    std::vector<TapeCode> stage;
+    std::map<uint, std::map<uint, double>> expr;
+    for (int k: order) {
+        if (k >= 0) { stage.push_back(_tape[k]); continue; }
+        const std::vector<uint> &region = regions[~k];
+        if (region.size() == 1) {
+            if (needed[_tape[region[0]].dst]) stage.push_back(_tape[region[0]]);
+            continue;
+        }
+        expr.clear();
+        for (uint i: region) {
+            const TapeCode &code = _tape[i];
+            std::map<uint, double> &y = expr[code.dst];
+            for (int j=code.cnt-1; j>=0; --j) {
+                uint a = _tapeargs[code.arg+j];
+                double g = _tapegains[code.arg+j];
+                if (prodreg[a] != ~k) { y[a] += g; continue; }
+                for (const auto &term: expr[a]) y[term.first] += g * term.second;
+            }
+        }
+        LinearBlock b;
+        std::map<uint, uint> col;
+        for (uint i: region) {
+            if (!needed[_tape[i].dst]) continue;
+            b.out.push_back(_tape[i].dst);
+            for (const auto &term: expr[_tape[i].dst]) col[term.first] = 0;
+        }
+        if (b.out.empty()) continue;
+        for (auto &c: col) {
+            c.second = b.in.size();
+            b.in.push_back(c.first);
+        }
+        uint nnz = 0;
+        for (uint y: b.out) nnz += expr[y].size();
+        b.dense = nnz >= SIMUCPP_LINEAR_DENSE * b.out.size() * b.in.size();
+        if (b.dense) b.val.assign(b.out.size() * b.in.size(), 0);
+        else b.row.push_back(0);
+        for (uint r=0; r<b.out.size(); ++r) {
+            for (const auto &term: expr[b.out[r]]) {
+                if (b.dense) { b.val[r*b.in.size() + col[term.first]] = term.second; continue; }
+                b.val.push_back(term.second);
+                b.col.push_back(col[term.first]);
+            }
+            if (!b.dense) b.row.push_back(b.val.size());
+        }
+        b.u.resize(b.in.size());
+        TapeCode code;
+        code.op = TAPE_LINEAR;
+        code.dst = b.out[0];
+        code.arg = _linear.size();
+        code.cnt = 0;
+        code.m = nullptr;
+        stage.push_back(code);
+        _linear.push_back(b);
+        _cntlinear += region.size();
+    }
+
+    // Sort the new stage segment by levels, the same as "Build_Stage()".
+    std::vector<uint> level(_cntM, 0), lvlof;
+    std::vector<u8> added(_cntM, 0);
+    uint maxlvl = 0, lvl;
+    for (const TapeCode &code: stage) {
+        reads.clear();
+        Tape_Reads(code, reads);
+        lvl = 0;
+        for (uint r: reads)
+            if (added[r]) lvl = SIMUCPP_MAX(lvl, level[r]);
+        lvl++;
+        lvlof.push_back(lvl);
+        maxlvl = SIMUCPP_MAX(maxlvl, lvl);
+        if (code.op == TAPE_LINEAR) {
+            for (uint y: _linear[code.arg].out) { added[y] = 1; level[y] = lvl; }
+        }
+        else if (code.op == TAPE_LOOP) {
+            for (uint y: _loops[code.arg].order) { added[y] = 1; level[y] = lvl; }
+            for (uint y: _loops[code.arg].tear) { added[y] = 1; level[y] = lvl; }
+        }
+        else { added[code.dst] = 1; level[code.dst] = lvl; }
+    }
+    std::vector<uint> offset(maxlvl+2, 0);
+    for (uint l: lvlof) offset[l+1]++;
+    for (uint l=1; l<=maxlvl+1; ++l) offset[l] += offset[l-1];
+    _tapelvl.assign(offset.begin()+1, offset.end());
+    std::vector<TapeCode> tape(stage.size());
+    for (uint i=0; i<stage.size(); ++i)
+        tape[offset[lvlof[i]]++] = stage[i];
+    tape.insert(tape.end(), _tape.begin()+_tapeseg[1], _tape.end());
+    _tape.swap(tape);
+    for (int s=1; s<4; ++s) _tapeseg[s] = _tapeseg[s] + stage.size() - n;
+    TRACELOG(LOG_DEBUG, "Simucpp: %d modules are merged into %d linear blocks.", _cntlinear, (int)_linear.size());
+}
+
+void Simulator::Tape_Reads(const TapeCode &code, std::vector<uint> &reads) {
+    if (code.op == TAPE_LINEAR) {
+        const LinearBlock &b = _linear[code.arg];
+        reads.insert(reads.end(), b.in.begin(), b.in.end());
+        return;
+    }
+    if (code.op == TAPE_LOOP) {
+        reads.insert(reads.end(), _depends[code.dst].begin(), _depends[code.dst].end());
+        return;
+    }
+    if ((code.op == TAPE_UPDATE) || (code.op == TAPE_DISCRETE)) {
+        PUnitModule bm;
+        for (int k=0; k<code.m->Get_childCnt(); ++k) {
+            bm = code.m->Get_child(k);
+            if (bm) reads.push_back(bm->_id);
+        }
+        return;
+    }
+    reads.insert(reads.end(), _tapeargs.begin()+code.arg, _tapeargs.begin()+code.arg+code.cnt);
+}
+
+void Simulator::Run_Linear(LinearBlock &b) {
+    const double *v = _outvalues.data();
+    const uint *in = b.in.data();
+    const uint rows = b.out.size(), cols = b.in.size();
+    double *u = b.u.data();
+    double ans;
+    for (uint c=0; c<cols; ++c)
+        u[c] = v[in[c]];
+    if (b.dense) {
+        const double *a = b.val.data();
+        for (uint r=0; r<rows; ++r, a+=cols) {
+            ans = 0;
+            for (uint c=0; c<cols; ++c)
+                ans += a[c] * u[c];
+            _outvalues[b.out[r]] = ans;
+        }
+        return;
+    }
+    const double *val = b.val.data();
+    const uint *col = b.col.data(), *row = b.row.data();
+    for (uint r=0; r<rows; ++r) {
+        ans = 0;
+        for (uint k=row[r]; k<row[r+1]; ++k)
+            ans += val[k] * u[col[k]];
+        _outvalues[b.out[r]] = ans;
+    }
+}
+
+
+void Simulator::Set_EnableLinear(bool linear) {
+    if (_status & FLAG_INITIALIZED) {
+        TRACELOG(LOG_WARNING, "Simulator: Linear blocks must be set before initialization.");
+        return;
+    }
+    if (linear) _status |= FLAG_LINEAR;
+    else _status &=~ FLAG_LINEAR;
+}
+uint Simulator::Get_LinearCount() { return _cntlinear; }
+
+NAMESPACE_SIMUCPP_R
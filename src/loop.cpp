@@ -0,0 +1,236 @@
+#include <cmath>
+#include <algorithm>
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Find algebraic loops by Tarjan's algorithm of strongly connected components.
+A module depends on its child modules in a stage except INTEGRATOR and
+ UNITDELAY modules, whose outputs don't depend on their inputs. Every loop
+ is represented by its first module in "_depends", which reads the inputs of
+ the whole loop, so sequence tables see a loop as one module and stay acyclic.
+**********************/
+void Simulator::Build_Loops() {
+    const uint n = _cntM;
+    std::vector<std::vector<uint>> child(n);
+    PUnitModule bm;
+    for (uint i=0; i<n; ++i) {
+        for (int k=0; k<_modules[i]->Get_childCnt(); ++k) {
+            bm = _modules[i]->Get_child(k);
+            if (bm==nullptr) continue;
+            if (typeid(*bm) == typeid(UIntegrator)) continue;
+            if (typeid(*bm) == typeid(UUnitDelay)) continue;
+            child[i].push_back(bm->_id);
+        }
+    }
+    _loops.clear();
+    _loopidx.assign(n, -1);
+    std::vector<int> index(n, -1), low(n, 0);
+    std::vector<u8> onstack(n, 0);
+    std::vector<uint> stack, scc;
+    std::vector<std::pair<uint, uint>> call;  // Module and index of its next child
+    int cnt = 0;
+    uint v, w;
+    for (uint s=0; s<n; ++s) {
+        if (index[s] >= 0) continue;
+        index[s] = low[s] = cnt++;
+        stack.push_back(s); onstack[s] = 1;
+        call.push_back(std::make_pair(s, 0u));
+        while (!call.empty()) {
+            v = call.back().first;
+            if (call.back().second < child[v].size()) {
+                w = child[v][call.back().second++];
+                if (index[w] < 0) {
+                    index[w] = low[w] = cnt++;
+                    stack.push_back(w); onstack[w] = 1;
+                    call.push_back(std::make_pair(w, 0u));
+                }
+                else if (onstack[w]) low[v] = SIMUCPP_MIN(low[v], index[w]);
+                continue;
+            }
+            call.pop_back();
+            if (!call.empty()) low[call.back().first] = SIMUCPP_MIN(low[call.back().first], low[v]);
+            if (low[v] != index[v]) continue;
+            scc.clear();
+            do {
+                w = stack.back(); stack.pop_back();
+                onstack[w] = 0;
+                scc.push_back(w);
+            } while (w != v);
+            if ((scc.size() == 1) && (std::find(child[v].begin(), child[v].end(), v) == child[v].end()))
+                continue;
+            std::sort(scc.begin(), scc.end());
+            Build_Loop(scc, child);
+        }
+    }
+
+    // Replace modules of loops by their representatives.
+    std::vector<uint> rep(n);
+    for (uint i=0; i<n; ++i) rep[i] = i;
+    for (const AlgebraicLoop &loop: _loops) {
+        uint r = n;
+        for (uint id: loop.order) r = SIMUCPP_MIN(r, id);
+        for (uint id: loop.tear) r = SIMUCPP_MIN(r, id);
+        for (uint id: loop.order) rep[id] = r;
+        for (uint id: loop.tear) rep[id] = r;
+    }
+    _depends.assign(n, std::vector<uint>());
+    for (uint i=0; i<n; ++i) {
+        if (rep[i] != i) continue;
+        for (uint c: child[i]) _depends[i].push_back(rep[c]);
+    }
+    // A representative reads the inputs of all modules of its loop once.
+    std::vector<uint> stamp(n, 0);
+    for (uint l=0; l<_loops.size(); ++l) {
+        uint r = rep[_loops[l].tear[0]];
+        std::vector<uint> &dep = _depends[r];
+        dep.clear();
+        for (int part=0; part<2; ++part)
+            for (uint id: part ? _loops[l].tear : _loops[l].order)
+                for (uint c: child[id]) {
+                    if ((rep[c] == r) || (stamp[rep[c]] == l+1)) continue;
+                    stamp[rep[c]] = l+1;
+                    dep.push_back(rep[c]);
+                }
+        _loopidx[r] = l;
+        TRACELOG(LOG_INFO, "Simulator: Algebraic loop of %d modules represented by \"%s\" is solved by %d torn modules.",
+            (int)(_loops[l].order.size()+_loops[l].tear.size()), _modules[r]->_name.c_str(), (int)_loops[l].tear.size());
+    }
+}
+
+/**********************
+Tear an algebraic loop. Other modules are sorted by Kahn's algorithm, and
+ when the remaining modules are all in cycles, the one read by the most
+ remaining modules is torn. Values of torn modules are unknowns of Newton
+ iterations, so the fewer the better.
+**********************/
+void Simulator::Build_Loop(const std::vector<uint> &scc, const std::vector<std::vector<uint>> &child) {
+    const uint n = scc.size();
+    std::vector<int> local(n);
+    std::vector<std::vector<uint>> readers(n);
+    std::vector<uint> deps(n), queue;
+    std::vector<u8> torn(n, 0), done(n, 0);
+    AlgebraicLoop loop;
+    uint best, cnt;
+    for (uint i=0; i<n; ++i)
+        for (uint c: child[scc[i]]) {
+            auto it = std::lower_bound(scc.begin(), scc.end(), c);
+            if ((it == scc.end()) || (*it != c)) continue;
+            readers[it - scc.begin()].push_back(i);
+        }
+    while (true) {
+        loop.order.clear();
+        queue.clear();
+        for (uint i=0; i<n; ++i) { deps[i] = 0; done[i] = torn[i]; }
+        for (uint i=0; i<n; ++i)
+            if (!torn[i]) for (uint j: readers[i]) deps[j]++;
+        for (uint i=0; i<n; ++i)
+            if (!torn[i] && (deps[i] == 0)) queue.push_back(i);
+        while (!queue.empty()) {
+            uint i = queue.back(); queue.pop_back();
+            done[i] = 1;
+            loop.order.push_back(scc[i]);
+            for (uint j: readers[i])
+                if (--deps[j] == 0 && !torn[j]) queue.push_back(j);
+        }
+        best = n; cnt = 0;
+        for (uint i=0; i<n; ++i) {
+            if (done[i]) continue;
+            uint r = 0;
+            for (uint j: readers[i]) r += !done[j];
+            if ((best == n) || (r > cnt)) { best = i; cnt = r; }
+        }
+        if (best == n) break;
+        torn[best] = 1;
+        loop.tear.push_back(scc[best]);
+    }
+    const uint m = loop.tear.size();
+    loop.jacob.resize(m*m);
+    loop.piv.resize(m);
+    loop.z.resize(m); loop.r.resize(m); loop.r1.resize(m); loop.dz.resize(m);
+    loop.factorized = loop.warned = false;
+    _loops.push_back(loop);
+}
+
+/**********************
+Newton iterations of "z=g(z)", where "g" updates torn modules from "z".
+The iteration matrix "I-dg/dz" is evaluated by finite differences and reused
+ across stages, and it's updated only when iterations converge slowly.
+If the matrix is singular or iterations don't converge, it's warned once and
+ torn modules keep the last iterate.
+**********************/
+void Simulator::Solve_Loop(AlgebraicLoop &loop) {
+    const uint m = loop.tear.size();
+    double *z = loop.z.data(), *r = loop.r.data(), *dz = loop.dz.data();
+    double nrm, nrm0 = 0, h, zj;
+    // Warm start from the last solution, and outputs are NaN after reset.
+    for (uint k=0; k<m; ++k) {
+        z[k] = _outvalues[loop.tear[k]];
+        if (!std::isfinite(z[k])) z[k] = 0;
+    }
+    for (int iter=0; iter<SIMUCPP_LOOP_MAXITER; ++iter) {
+        Loop_Update(loop, z, r);
+        if (!loop.factorized) {
+            for (uint j=0; j<m; ++j) {
+                zj = z[j];
+                h = SIMUCPP_JACOBIAN_DELTA * SIMUCPP_MAX(fabs(zj), 1.0);
+                z[j] = zj + h;
+                Loop_Update(loop, z, loop.r1.data());
+                z[j] = zj;
+                for (uint i=0; i<m; ++i)
+                    loop.jacob[i*m+j] = (loop.r1[i] - r[i]) / h;
+            }
+            if (!LU_Decompose(loop.jacob.data(), loop.piv.data(), m)) {
+                if (!loop.warned) {
+                    TRACELOG(LOG_WARNING, "Simucpp: Jacobian of algebraic loop of \"%s\" is singular at time %f.",
+                        _modules[loop.tear[0]]->_name.c_str(), _t);
+                    loop.warned = true;
+                }
+                Loop_Update(loop, z, nullptr);
+                return;
+            }
+            loop.factorized = true;
+        }
+        for (uint k=0; k<m; ++k) dz[k] = r[k];
+        LU_Solve(loop.jacob.data(), loop.piv.data(), m, dz);
+        nrm = 0;
+        for (uint k=0; k<m; ++k) {
+            z[k] -= dz[k];
+            nrm = SIMUCPP_MAX(nrm, fabs(dz[k]) / (1 + fabs(z[k])));
+        }
+        if (nrm <= SIMUCPP_LOOP_TOL) {
+            Loop_Update(loop, z, nullptr);
+            return;
+        }
+        if ((iter > 0) && (nrm > 0.25*nrm0)) loop.factorized = false;
+        nrm0 = nrm;
+    }
+    if (!loop.warned) {
+        TRACELOG(LOG_WARNING, "Simucpp: Newton iterations of algebraic loop of \"%s\" didn't converge at time %f.",
+            _modules[loop.tear[0]]->_name.c_str(), _t);
+        loop.warned = true;
+    }
+    Loop_Update(loop, z, nullptr);
+}
+void Simulator::Loop_Update(AlgebraicLoop &loop, const double *z, double *r) {
+    double *v = _outvalues.data();
+    for (uint k=0; k<loop.tear.size(); ++k)
+        v[loop.tear[k]] = z[k];
+    for (uint id: loop.order)
+        _modules[id]->Module_Update(_t);
+    if (!r) return;
+    for (uint k=0; k<loop.tear.size(); ++k) {
+        _modules[loop.tear[k]]->Module_Update(_t);
+        r[k] = z[k] - v[loop.tear[k]];
+        v[loop.tear[k]] = z[k];
+    }
+}
+void Simulator::Update_Module(uint id) {
+    if (_loopidx[id] >= 0) Solve_Loop(_loops[_loopidx[id]]);
+    else _modules[id]->Module_Update(_t);
+}
+
+uint Simulator::Get_LoopCount() { return _loops.size(); }
+
+NAMESPACE_SIMUCPP_R
@@ -0,0 +1,199 @@
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+enum FOLD_STATE {
+    FOLD_UNKNOWN,
+    FOLD_VISITING,
+    FOLD_CONSTANT,
+    FOLD_VARIABLE,
+};
+
+PUnitModule* Simulator::Child_Slot(PUnitModule m, uint n) {
+    CHILD_SLOT(UFcn);
+    CHILD_SLOTS(UFcnMISO);
+    CHILD_SLOT(UGain);
+    CHILD_SLOT(UIntegrator);
+    CHILD_SLOT(UOutput);
+    CHILD_SLOTS(UProduct);
+    CHILD_SLOTS(USum);
+    if (typeid(*m) == typeid(UTransportDelay)) {
+        UTransportDelay *mdl = (UTransportDelay*)m;
+        return n==0 ? &mdl->_next : (n==1 && mdl->_delayin ? &mdl->_delayin : nullptr);
+    }
+    CHILD_SLOT(UUnitDelay);
+    CHILD_SLOT(UZOH);
+    return nullptr;
+}
+
+bool Simulator::Gain_Of(PUnitModule m, double &g, PUnitModule &in) {
+    if (m == nullptr) return false;
+    if (typeid(*m) == typeid(UGain)) {
+        UGain *mdl = (UGain*)m;
+        if (!mdl->_enable || !mdl->_next) return false;
+        g = mdl->_gain; in = mdl->_next;
+        return true;
+    }
+    if (typeid(*m) == typeid(USum)) {
+        USum *mdl = (USum*)m;
+        if (!mdl->_enable || (mdl->_next.size() != 1) || !mdl->_next[0]) return false;
+        g = mdl->_ingain[0]; in = mdl->_next[0];
+        return true;
+    }
+    return false;
+}
+
+/**********************
+A module is folded if it's a CONSTANT module, or a SUM, GAIN or PRODUCT
+ module whose inputs are all folded. Its value is evaluated in the same way
+ as its "Module_Update()" and saved to its output value.
+**********************/
+bool Simulator::Fold_Constant(PUnitModule m, std::vector<u8> &state) {
+    u8 &s = state[m->_id];
+    if (s == FOLD_CONSTANT) return true;
+    if ((s == FOLD_VARIABLE) || (s == FOLD_VISITING)) return false;
+    if (typeid(*m) == typeid(UConstant)) { s = FOLD_CONSTANT; return true; }
+    s = FOLD_VARIABLE;
+    if ((typeid(*m) != typeid(USum)) && (typeid(*m) != typeid(UGain))
+        && (typeid(*m) != typeid(UProduct))) return false;
+    if (!m->_enable || (m->Get_childCnt() == 0)) return false;
+    s = FOLD_VISITING;
+    for (int k=0; k<m->Get_childCnt(); ++k) {
+        PUnitModule bm = m->Get_child(k);
+        if (bm && Fold_Constant(bm, state)) continue;
+        s = FOLD_VARIABLE;
+        return false;
+    }
+    m->Module_Update(0);
+    for (int k=0; k<m->Get_childCnt(); ++k) {
+        PUnitModule bm = m->Get_child(k);
+        if (typeid(*bm) == typeid(UConstant)) ((UConstant*)bm)->_folded = true;
+    }
+    s = FOLD_CONSTANT;
+    return true;
+}
+
+/**********************
+Optimize the graph of unit modules before IDs are rearranged.
+Folded modules read by other modules are replaced by new CONSTANT modules,
+ then chains of gains are bypassed or merged, and modules unreachable from
+ INTEGRATOR, UNITDELAY and OUTPUT modules are removed and the remaining
+ modules are renumbered. New CONSTANT modules are deleted with the simulator.
+**********************/
+void Simulator::Optimize_Modules() {
+    const uint cnt = _cntM;
+    uint folded = 0, merged = 0, removed = 0;
+    PUnitModule m, bm, *slot;
+    std::vector<u8> state(cnt, FOLD_UNKNOWN);
+    std::vector<PUnitModule> constant(cnt, nullptr);
+    double g;
+    bool linear;
+    int entry;
+
+    /* Fold constant subtrees and bypass or merge gains */
+    // Gains set by users are kept in "_merged", so that parameters of merged
+    //  gains are reported and changed without the merged factors.
+    // Values of input ports of co-simulation are changed in simulation.
+    for (PUnitModule m: _coinputs) state[m->_id] = FOLD_VARIABLE;
+    // So are values of CONSTANT modules whose parameter handles will be got.
+    for (PUnitModule m: _modules)
+        if ((typeid(*m) == typeid(UConstant)) && ((UConstant*)m)->_tunable) state[m->_id] = FOLD_VARIABLE;
+    for (uint i=0; i<cnt; ++i)
+        Fold_Constant(_modules[i], state);
+    for (uint i=0; i<cnt; ++i) {
+        m = _modules[i];
+        if (state[i] == FOLD_CONSTANT) continue;
+        linear = (typeid(*m) == typeid(UGain)) || (typeid(*m) == typeid(USum))
+            || (typeid(*m) == typeid(UProduct));
+        for (uint k=0; (slot = Child_Slot(m, k)); ++k) {
+            entry = -1;
+            for (uint step=0; step<cnt; ++step) {
+                bm = *slot;
+                if (bm == nullptr) break;
+                if ((bm->_id >= 0) && ((uint)bm->_id < cnt) && (state[bm->_id] == FOLD_CONSTANT)
+                    && (typeid(*bm) != typeid(UConstant))) {
+                    if (!constant[bm->_id]) {
+                        constant[bm->_id] = new UConstant(this, bm->_name+"_fold");
+                        _foldmodules.push_back(constant[bm->_id]);
+                        ((UConstant*)constant[bm->_id])->Set_OutValue(bm->Get_OutValue());
+                        folded++;
+                    }
+                    *slot = constant[bm->_id];
+                    break;
+                }
+                if (!Gain_Of(bm, g, bm)) break;
+                if (g == 1) { *slot = bm; merged++; continue; }
+                if (!linear) break;
+                double &gain = typeid(*m) == typeid(UGain) ? ((UGain*)m)->_gain :
+                    typeid(*m) == typeid(USum) ? ((USum*)m)->_ingain[k] : ((UProduct*)m)->_ingain[k];
+                if (entry < 0) {
+                    MergedGain mg = {m, k, gain, 1};
+                    entry = _merged.size();
+                    _merged.push_back(mg);
+                }
+                _merged[entry].factor *= g;
+                gain *= g;
+                *slot = bm;
+                merged++;
+            }
+        }
+    }
+
+    /* Remove modules unreachable from INTEGRATOR, UNITDELAY and OUTPUT modules */
+    std::vector<u8> reached(_cntM, 0);
+    std::vector<PUnitModule> stack;
+    for (PUnitModule m: _modules) {
+        if ((typeid(*m) != typeid(UIntegrator)) && (typeid(*m) != typeid(UUnitDelay))
+            && (typeid(*m) != typeid(UOutput))) continue;
+        reached[m->_id] = 1;
+        stack.push_back(m);
+    }
+    for (PUnitModule m: _coinputs) reached[m->_id] = 1;
+    while (!stack.empty()) {
+        m = stack.back(); stack.pop_back();
+        for (int k=0; k<m->Get_childCnt(); ++k) {
+            bm = m->Get_child(k);
+            if ((bm == nullptr) || reached[bm->_id]) continue;
+            reached[bm->_id] = 1;
+            stack.push_back(bm);
+        }
+    }
+    std::vector<int> newid(_cntM, -1);
+    std::vector<PUnitModule> modules;
+    for (PUnitModule m: _modules) {
+        if (!reached[m->_id]) { m->_id = -1; removed++; continue; }
+        newid[m->_id] = modules.size();
+        m->_id = modules.size();
+        modules.push_back(m);
+    }
+    _cntremoved = removed;
+    _modules.swap(modules);
+    std::vector<MergedGain> merges;
+    for (const MergedGain &mg: _merged)
+        if (mg.m->_id >= 0) merges.push_back(mg);
+    _merged.swap(merges);
+    _cntM = _modules.size();
+    for (auto &ids: _integIDs) ids[0] = newid[ids[0]];
+    for (auto &ids: _delayIDs) ids[0] = newid[ids[0]];
+    for (auto &ids: _outIDs) ids[0] = newid[ids[0]];
+    TRACELOG(LOG_INFO, "Simulator: Optimization removed %d modules, folded %d constants and merged %d gains.",
+        _cntremoved, folded, merged);
+}
+
+
+void Simulator::Set_EnableOptimize(bool optimize) {
+    if (_status & FLAG_INITIALIZED) {
+        TRACELOG(LOG_WARNING, "Simulator: Optimization must be set before initialization.");
+        return;
+    }
+    if (optimize) _status |= FLAG_OPTIMIZE;
+    else _status &=~ FLAG_OPTIMIZE;
+}
+uint Simulator::Get_RemovedCount() { return _cntremoved; }
+int Simulator::Find_Merged(PUnitModule m, uint port) {
+    for (uint i=0; i<_merged.size(); ++i)
+        if ((_merged[i].m == m) && (_merged[i].port == port)) return i;
+    return -1;
+}
+
+NAMESPACE_SIMUCPP_R
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Find the copy of a parameter in the instruction tape. The gains of SUM, GAIN
+ and PRODUCT instructions are copied from their modules in "Build_Tape()",
+ and also to "_lanegains" in ensemble mode, which has the same index.
+**********************/
+int Simulator::Get_Parameter(PUnitModule m, std::string name, uint port) {
+    CHECK_NULLPTR(m, UnitModule);
+    if (!(_status & FLAG_INITIALIZED))
+        TRACELOG(LOG_FATAL, "Simulator: Parameters can only be got from initialized simulators!");
+    if ((m->_id < 0) || (m->_id >= (int)_cntM) || (_modules[m->_id] != m)) {
+        TRACELOG(LOG_WARNING, "Simulator: Module \"%s\" isn't in this simulator or is removed by optimization.", m->_name.c_str());
+        return -1;
+    }
+    Parameter p;
+    p.id = m->_id;
+    p.port = port;
+    p.arg = -1;
+    p.merged = -1;
+    if ((name == "gain") && (typeid(*m) == typeid(UGain))) p.kind = PARAM_GAIN;
+    else if ((name == "ingain") && (typeid(*m) == typeid(USum)) && (port < ((USum*)m)->_ingain.size()))
+        p.kind = PARAM_INGAIN;
+    else if ((name == "ingain") && (typeid(*m) == typeid(UProduct)) && (port < ((UProduct*)m)->_ingain.size()))
+        p.kind = PARAM_INGAIN;
+    else if ((name == "value") && (typeid(*m) == typeid(UConstant))) {
+        p.kind = PARAM_VALUE;
+        if (((UConstant*)m)->_folded)
+            TRACELOG(LOG_WARNING, "Simulator: Modules reading \"%s\" are folded by optimization, and its parameter "
+                "doesn't change them. See \"UConstant::Set_Tunable()\".", m->_name.c_str());
+    }
+    else if ((name == "initial") && (typeid(*m) == typeid(UIntegrator))) p.kind = PARAM_INITIAL;
+    else {
+        TRACELOG(LOG_WARNING, "Simulator: Module \"%s\" doesn't have parameter \"%s\" of port %d.",
+            m->_name.c_str(), name.c_str(), port);
+        return -1;
+    }
+    if ((p.kind == PARAM_GAIN) || (p.kind == PARAM_INGAIN)) {
+        p.merged = Find_Merged(m, port);
+        for (const TapeCode &code: _tape) {
+            if (code.dst != p.id) continue;
+            if ((code.op != TAPE_SUM) && (code.op != TAPE_GAIN) && (code.op != TAPE_PRODUCT)) continue;
+            p.arg = code.arg + port;
+            break;
+        }
+        // Modules of algebraic loops are updated by themselves instead of the tape.
+        bool inloop = false;
+        for (const AlgebraicLoop &loop: _loops) {
+            inloop |= std::find(loop.order.begin(), loop.order.end(), p.id) != loop.order.end();
+            inloop |= std::find(loop.tear.begin(), loop.tear.end(), p.id) != loop.tear.end();
+        }
+        if ((p.arg < 0) && (_status & FLAG_TAPE) && m->_enable && !inloop) {
+            TRACELOG(LOG_WARNING, "Simulator: Module \"%s\" is merged into a linear block, and its parameter "
+                "can't be changed.", m->_name.c_str());
+            return -1;
+        }
+    }
+    _params.push_back(p);
+    return _params.size() - 1;
+}
+void Simulator::Set_Parameter(int handle, double value) {
+    if ((handle < 0) || (handle >= (int)_params.size())) {
+        TRACELOG(LOG_WARNING, "Simulator: Parameter handle %d is invalid.", handle);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(*_parammutex);
+    _parampending.push_back(std::make_pair((uint)handle, value));
+}
+double Simulator::Get_ParameterValue(int handle) {
+    if ((handle < 0) || (handle >= (int)_params.size())) {
+        TRACELOG(LOG_WARNING, "Simulator: Parameter handle %d is invalid.", handle);
+        return 0;
+    }
+    const Parameter &p = _params[handle];
+    PUnitModule m = _modules[p.id];
+    if (p.merged >= 0) return _merged[p.merged].gain;
+    switch (p.kind) {
+    case PARAM_GAIN: return ((UGain*)m)->_gain;
+    case PARAM_INGAIN:
+        if (typeid(*m) == typeid(USum)) return ((USum*)m)->_ingain[p.port];
+        return ((UProduct*)m)->_ingain[p.port];
+    case PARAM_VALUE: return m->Get_OutValue();
+    default: return ((UIntegrator*)m)->_iv;
+    }
+}
+
+/**********************
+Apply queued values of parameters to modules and their copies in the tape.
+The queue is swapped out under the lock, so the setting thread is blocked
+ only for a moment.
+**********************/
+void Simulator::Apply_Parameters() {
+    {
+        std::lock_guard<std::mutex> lock(*_parammutex);
+        if (_parampending.empty()) return;
+        _paramapply.swap(_parampending);
+    }
+    const uint L = _lanes;
+    for (const std::pair<uint, double> &item: _paramapply) {
+        const Parameter &p = _params[item.first];
+        double v = item.second;
+        PUnitModule m = _modules[p.id];
+        // Gains merged into the module by optimization are kept.
+        if (p.merged >= 0) {
+            _merged[p.merged].gain = v;
+            v *= _merged[p.merged].factor;
+        }
+        switch (p.kind) {
+        case PARAM_GAIN:
+            ((UGain*)m)->_gain = v;
+            break;
+        case PARAM_INGAIN:
+            if (typeid(*m) == typeid(USum)) ((USum*)m)->_ingain[p.port] = v;
+            else ((UProduct*)m)->_ingain[p.port] = v;
+            break;
+        case PARAM_VALUE:
+            for (uint l=0; l<L; ++l) _outvalues[p.id*L+l] = v;
+            break;
+        case PARAM_INITIAL:
+            ((UIntegrator*)m)->_iv = v;
+            if (L > 1) for (uint l=0; l<L; ++l) _laneinit[p.id*L+l] = v;
+            break;
+        }
+        if (p.arg < 0) continue;
+        if (_jitfcn[0] && (_tapegains[p.arg] != v)) {
+            TRACELOG(LOG_WARNING, "Simulator: Gains are constants of the compiled model, so the tape is used instead.");
+            for (int i=0; i<3; ++i) _jitfcn[i] = nullptr;
+        }
+        _tapegains[p.arg] = v;
+        if (L > 1) for (uint l=0; l<L; ++l) _lanegains[p.arg*L+l] = v;
+    }
+    _paramapply.clear();
+}
+
+NAMESPACE_SIMUCPP_R
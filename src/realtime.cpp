@@ -0,0 +1,74 @@
+#include <cmath>
+#include <thread>
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+void Simulator::Set_EnableRealTime(bool realtime, double spin) {
+    if (realtime) _status |= FLAG_REALTIME;
+    else _status &=~ FLAG_REALTIME;
+    _rtspin = spin>0 ? spin : 0;
+    _rthist.assign(SIMUCPP_RT_DECADES*SIMUCPP_RT_DECADE_BINS, 0);
+    Reset_RealTime();
+}
+void Simulator::Reset_RealTime() {
+    _rtanchored = false;
+    _rtsteps = _rtoverruns = 0;
+    _rtmax = 0;
+    std::fill(_rthist.begin(), _rthist.end(), 0);
+}
+
+/**********************
+Pacing of simulation steps. The wall-clock time is anchored at the beginning
+ of the first step, and every step is released when its simulation time is
+ reached and has to finish before the release of the next step. Deadlines
+ follow the anchor, so a late step doesn't shift later deadlines. The latency
+ of a step is the time from its release to its end, and it's counted in a
+ histogram of "SIMUCPP_RT_DECADE_BINS" bins per decade, which is allocated
+ by "Set_EnableRealTime()".
+**********************/
+void Simulator::RealTime_Begin() {
+    if (!_rtanchored) {
+        _rtanchor = std::chrono::steady_clock::now();
+        _rtt0 = _t;
+        _rtanchored = true;
+    }
+    _rtstart = _t;
+}
+void Simulator::RealTime_Pace() {
+    typedef std::chrono::steady_clock clock;
+    typedef std::chrono::duration<double> seconds;
+    clock::time_point now = clock::now();
+    clock::time_point release = _rtanchor + std::chrono::duration_cast<clock::duration>(seconds(_rtstart-_rtt0));
+    clock::time_point deadline = _rtanchor + std::chrono::duration_cast<clock::duration>(seconds(_t-_rtt0));
+    double latency = seconds(now - release).count();
+    int bin = SIMUCPP_RT_DECADE_BINS * log10(SIMUCPP_MAX(latency, SIMUCPP_RT_MIN_LATENCY) / SIMUCPP_RT_MIN_LATENCY);
+    _rthist[SIMUCPP_MIN(bin, (int)_rthist.size()-1)]++;
+    _rtmax = SIMUCPP_MAX(_rtmax, latency);
+    _rtsteps++;
+    if (now > deadline) { _rtoverruns++; return; }
+    // Sleep until a moment before the deadline, and spin for the rest.
+    clock::time_point wake = deadline - std::chrono::duration_cast<clock::duration>(seconds(_rtspin));
+    if (now < wake) std::this_thread::sleep_until(wake);
+    while (clock::now() < deadline) {}
+}
+
+RealTimeStats Simulator::Get_RealTimeStats() {
+    RealTimeStats stats;
+    stats.steps = _rtsteps;
+    stats.overruns = _rtoverruns;
+    stats.max = _rtmax;
+    stats.p50 = stats.p99 = 0;
+    uint cnt = 0;
+    for (uint b=0; b<_rthist.size(); ++b) {
+        if (!_rthist[b]) continue;
+        // Upper bound of the bin, but not beyond the maximum.
+        double v = SIMUCPP_MIN(_rtmax, SIMUCPP_RT_MIN_LATENCY * pow(10, double(b+1)/SIMUCPP_RT_DECADE_BINS));
+        if ((cnt < 0.5*_rtsteps) && (cnt+_rthist[b] >= 0.5*_rtsteps)) stats.p50 = v;
+        if ((cnt < 0.99*_rtsteps) && (cnt+_rthist[b] >= 0.99*_rtsteps)) stats.p99 = v;
+        cnt += _rthist[b];
+    }
+    return stats;
+}
+
+NAMESPACE_SIMUCPP_R
@@ -0,0 +1,41 @@
+#include <algorithm>
+#include "ringbuffer.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+RingBuffer::RingBuffer(size_t capacity): _buf(capacity), _head(0), _size(0) {}
+void RingBuffer::Set_Capacity(size_t capacity) {
+    if (capacity == _buf.size()) return;
+    std::vector<double> values;
+    Copy(values);
+    size_t n = SIMUCPP_MIN(values.size(), capacity);
+    std::vector<double>(capacity).swap(_buf);
+    std::copy(values.end()-n, values.end(), _buf.begin());
+    _size = n;
+    _head = capacity>0 ? n%capacity : 0;
+}
+size_t RingBuffer::Capacity() const { return _buf.size(); }
+size_t RingBuffer::Size() const { return _size; }
+void RingBuffer::Clear() { _head = _size = 0; }
+double RingBuffer::operator[](size_t n) const {
+    n += _head + _buf.size() - _size;
+    return _buf[n<_buf.size() ? n : n-_buf.size()];
+}
+void RingBuffer::Get_Spans(TraceView &older, TraceView &newer) const {
+    if (_size < _buf.size()) {
+        older = TraceView{_buf.data(), _size};
+        newer = TraceView{_buf.data(), 0};
+        return;
+    }
+    older = TraceView{_buf.data() + _head, _buf.size() - _head};
+    newer = TraceView{_buf.data(), _head};
+}
+void RingBuffer::Copy(std::vector<double> &out) const {
+    TraceView older, newer;
+    Get_Spans(older, newer);
+    out.resize(_size);
+    std::copy(older.begin(), older.end(), out.begin());
+    std::copy(newer.begin(), newer.end(), out.begin()+older.size);
+}
+
+NAMESPACE_SIMUCPP_R
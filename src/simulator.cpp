@@ -1,35 +1,13 @@
-#include <stack>
 #include <cmath>
 #include <algorithm>
 #include "simulator.hpp"
 #include "definitions.hpp"
+#include "threadpool.hpp"
 #ifdef USE_MPLT
 #include "matplotlibcpp.h"
 #endif
 NAMESPACE_SIMUCPP_L
 
-enum {
-    FLAG_INITIALIZED  = 0x01,   // Whether to store simulation data to memory
-    FLAG_DIVERGED     = 0x02,   // Set to run program in fullscreen
-    FLAG_STORE        = 0x04,   // Set to allow resizable window
-    FLAG_REDUNDANT    = 0x08,   // Clear to delete redundant modules
-} SimulatorFlags;
-
-bool Find_vector(std::vector<uint>& data, int x) {
-    std::vector<uint>::iterator iter = std::find(data.begin(), data.end(), x);
-    return iter != data.end();
-}
-
-void Print_Connection(std::vector<uint> &ids) {
-#if defined(SUPPORT_DEBUG)
-    std::cout << "Sequence table: ";
-    for (int i: ids) {
-        std::cout << i << ", ";
-    }
-    std::cout << std::endl;
-#endif  // SUPPORT_DEBUG
-}
-
 /**********************
 **********************/
 Simulator::Simulator(double endtime) {
@@ -37,16 +15,125 @@ Simulator::Simulator(double endtime) {
     _endtime = endtime;
     _cntM = 0;
     _t = 0;
-    _status = FLAG_STORE | FLAG_REDUNDANT;
+    _status = FLAG_STORE | FLAG_REDUNDANT | FLAG_TAPE;
     DISCRETE_INITIALIZE(-1);
-    for(int i=0; i<4; ++i) _ode4K[i] = nullptr;
+    for(int i=0; i<7; ++i) _odeK[i] = nullptr;
+    for(int i=0; i<4; ++i) _tapeseg[i] = 0;
+    _tapebufw = 0;
+    _cntlinear = 0;
+    _cntremoved = 0;
+    _pool = nullptr;
+    _threads = 1; _grain = 256;
+    _lanes = 1;
+    _cntX = 0;
+    for(int i=0; i<3; ++i) _jitfcn[i] = nullptr;
+    _parammutex = std::make_shared<std::mutex>();
+    _rtspin = 0;
+    _storetime = false;
+    _tmax = 0;
+    _tpacked = CompressedSeries(true);
+    Reset_RealTime();
     _divmode = 0;
+    _solver = SOLVER_RK4;
+    Set_Tolerance();
+    Set_MaxStep();
+    _cntstep = _cntreject = _cntjacob = 0;
+    _jacobstate = 0;
+    _hasprev = false;
 }
 Simulator::~Simulator() {
-    for(int i=0; i<4; ++i) {
-        if (!_ode4K[i]) continue;
-        delete _ode4K[i]; _ode4K[i] = nullptr;
+    for(int i=0; i<7; ++i) {
+        if (!_odeK[i]) continue;
+        delete[] _odeK[i]; _odeK[i] = nullptr;
+    }
+    if (_pool) { delete _pool; _pool = nullptr; }
+    if (_status & FLAG_OWNER) {
+        for (PUnitModule m: _modules) delete m;
+        _modules.clear();
+    }
+    else for (PUnitModule m: _foldmodules) delete m;
+}
+
+
+/**********************
+Deep copy of an initialized simulator.
+Unit modules are copied by their copy constructors first, so nothing is left
+ to clean up if one of them can't be copied. Then the simulator is copied
+ memberwise, and every pointers in it are replaced: children of modules are
+ remapped by IDs, which are the same in both simulators.
+**********************/
+PUnitModule Simulator::Clone_Module(PUnitModule m) {
+    CLONE_MODULE(UConstant);
+    CLONE_MODULE(UFcn);
+    CLONE_MODULE(UFcnMISO);
+    CLONE_MODULE(UGain);
+    CLONE_MODULE(UInput);
+    CLONE_MODULE(UIntegrator);
+    CLONE_MODULE(UNoise);
+    CLONE_MODULE(UOutput);
+    CLONE_MODULE(UProduct);
+    CLONE_MODULE(USum);
+    CLONE_MODULE(UTransportDelay);
+    CLONE_MODULE(UUnitDelay);
+    CLONE_MODULE(UZOH);
+    TRACELOG(LOG_WARNING, "Simucpp: Module \"%s\" of an unknown class cannot be cloned!", m->_name.c_str());
+    return nullptr;
+}
+Simulator* Simulator::Clone() {
+    if (!(_status & FLAG_INITIALIZED))
+        TRACELOG(LOG_FATAL, "Simulator: Only initialized simulators can be cloned!");
+    std::vector<PUnitModule> copies(_modules.size(), nullptr);
+    for (uint i=0; i<_modules.size(); ++i) {
+        if (!_modules[i] || (copies[i] = Clone_Module(_modules[i]))) continue;
+        for (PUnitModule m: copies) delete m;
+        return nullptr;
     }
+    PSimulator sim = new Simulator(*this);
+    std::vector<PUnitModule> &modules = sim->_modules;
+    modules.swap(copies);
+    sim->_status |= FLAG_OWNER;
+    sim->_foldmodules.clear();
+    for(int i=0; i<7; ++i) {
+        sim->_odeK[i] = new double[_cntX];
+        std::copy(_odeK[i], _odeK[i]+_cntX, sim->_odeK[i]);
+    }
+    sim->_pool = nullptr;
+    sim->_parammutex = std::make_shared<std::mutex>();
+    sim->Build_Phase();
+    for (PUnitModule m: modules) {
+        if (!m) continue;
+        m->_sim = sim;
+        m->_outvalue = &sim->_outvalues[m->_id*_lanes];
+        CLONE_CHILD(UFcn);
+        CLONE_CHILDREN(UFcnMISO);
+        CLONE_CHILD(UGain);
+        CLONE_CHILD(UIntegrator);
+        CLONE_CHILD(UOutput);
+        if (typeid(*m) == typeid(UOutput)) ((UOutput*)m)->_sink = nullptr;
+        CLONE_CHILDREN(UProduct);
+        CLONE_CHILDREN(USum);
+        CLONE_CHILD(UTransportDelay);
+        if (typeid(*m) == typeid(UTransportDelay)) {
+            UTransportDelay *mdl = (UTransportDelay*)m;
+            if (mdl->_delayin) mdl->_delayin = modules[mdl->_delayin->_id];
+        }
+        CLONE_CHILD(UUnitDelay);
+        CLONE_CHILD(UZOH);
+    }
+    for (PUIntegrator &m: sim->_integrators) m = (PUIntegrator)modules[m->_id];
+    for (PUOutput &m: sim->_outputs) m = (PUOutput)modules[m->_id];
+    for (PUUnitDelay &m: sim->_unitdelays) m = (PUUnitDelay)modules[m->_id];
+    for (PUnitModule &m: sim->_coinputs) m = modules[m->_id];
+    for (PUnitModule &m: sim->_cooutputs) m = modules[m->_id];
+    for (MergedGain &mg: sim->_merged) mg.m = modules[mg.m->_id];
+    for (TapeCode &code: sim->_tape) code.m = modules[code.dst];
+    return sim;
+}
+PUnitModule Simulator::Get_Module(PUnitModule m) {
+    CHECK_NULLPTR(m, UnitModule);
+    if ((m->_id < 0) || (m->_id >= (int)_modules.size()))
+        TRACELOG(LOG_FATAL, "Simulator: Module \"%s\" is not found!", m->_name.c_str());
+    return _modules[m->_id];
 }
 
 
@@ -61,18 +148,18 @@ void Simulator::Add_Module(const PUnitModule m) {
     if (typeid(*m) == typeid(UIntegrator)){
         _integrators.push_back((PUIntegrator)m);
         _integIDs.push_back(std::vector<uint>{_cntM});
-        _discIDs.push_back(_cntM);
         _outref.push_back(m->Get_OutValue());
     }
     else if (typeid(*m) == typeid(UOutput)){
         _outputs.push_back((PUOutput)m);
         _outIDs.push_back(std::vector<uint>{_cntM});
-        _discIDs.push_back(_cntM);
     }
     else if (typeid(*m) == typeid(UUnitDelay)){
         _unitdelays.push_back((PUUnitDelay)m);
         _delayIDs.push_back(std::vector<uint>{_cntM});
-        _discIDs.push_back(_cntM);
+    }
+    else if (typeid(*m) == typeid(UNoise)){
+        ((UNoise*)m)->Set_Seed(_cntM);
     }
     _cntM++;
 }
@@ -84,6 +171,7 @@ void Simulator::Add_Module(const PMatModule m) {
 
 /**********************
 Simulation initialization procedure, which includes the following steps:
+ - Optimize the graph of unit modules if enabled.
  - Self check procedure of unit modules and simulators;
  - Delete redundant connections.
  - Build sequence table.
@@ -110,15 +198,61 @@ void Simulator::Initialize(bool print) {
     }
     if (cntdown<0) TRACELOG(LOG_FATAL, "Simucpp: Matrix modules initialization failed!");
     _matmodules.clear();
+    if (_status & FLAG_OPTIMIZE) Optimize_Modules();
     _cntI = _integIDs.size();
     _cntO = _outIDs.size();
     _cntD = _delayIDs.size();
     TRACELOG(LOG_DEBUG, "Simucpp: Matrix modules initialization completed.");
 
+    /* Rearrange IDs to put INTEGRATOR modules first, and bind output values to slots */
+    std::vector<uint> newid(_cntM);
+    std::vector<PUnitModule> modules;
+    std::vector<u8> placed(_cntM, 0);
+    for (PUIntegrator m: _integrators) {
+        newid[m->_id] = modules.size();
+        modules.push_back(m);
+        placed[m->_id] = 1;
+    }
+    // Co-simulation ports follow INTEGRATOR modules, so their slots are contiguous.
+    for (int k=0; k<2; ++k)
+        for (PUnitModule m: k ? _cooutputs : _coinputs) {
+            if (m->_id < 0) TRACELOG(LOG_FATAL, "Simucpp: Port \"%s\" is removed by optimization!", m->_name.c_str());
+            newid[m->_id] = modules.size();
+            modules.push_back(m);
+            placed[m->_id] = 1;
+        }
+    for (PUnitModule m: _modules) {
+        if (placed[m->_id]) continue;
+        newid[m->_id] = modules.size();
+        modules.push_back(m);
+    }
+    _modules.swap(modules);
+    for (auto &ids: _integIDs) ids[0] = newid[ids[0]];
+    for (auto &ids: _delayIDs) ids[0] = newid[ids[0]];
+    for (auto &ids: _outIDs) ids[0] = newid[ids[0]];
+    _cntX = _cntI * _lanes;
+    _outvalues.resize(_cntM * _lanes);
+    for(uint i=0; i<_cntM; ++i) {
+        curm = _modules[i];
+        curm->_id = i;
+        for (uint l=0; l<_lanes; ++l)
+            _outvalues[i*_lanes+l] = *curm->_outvalue;
+        curm->_outvalue = &_outvalues[i*_lanes];
+    }
+    _outref.resize(_cntX);
+
     /* Self check procedure of unit modules and simulators */
-    for(int i=0; i<4; ++i) _ode4K[i] = new double[_cntI];
+    for(int i=0; i<7; ++i) _odeK[i] = new double[_cntX];
+    // Buffers of BDF2 are allocated here, so restoring states doesn't allocate them.
+    _hasprev = false;
+    if (_solver == SOLVER_BDF2) {
+        _xprev.resize(_cntX);
+        _jacob.resize(_cntX*_cntX); _jacoblu.resize(_cntX*_cntX);
+        _jacobpiv.resize(_cntX);
+    }
+    _hstep = _H+_H;
     if (_H<=0) TRACELOG(LOG_FATAL, "Simucpp: Simulation step must be greator than zero!");
-    for(int i=0; i<_cntM; ++i) {
+    for(uint i=0; i<_cntM; ++i) {
         errcode = _modules[i]->Self_Check();
         if (errcode!=0) TRACELOG(LOG_ERROR, "Simucpp: Self check of module \"%s\" failed!"
             "Errcode: %d", _modules[i]->_name.c_str(), errcode);
@@ -143,36 +277,61 @@ void Simulator::Initialize(bool print) {
     }
     if (print) Print_Modules();
 
+    /* Find algebraic loops */
+    Build_Loops();
+
     /* Build sequence table */
-    for(int i=0; i<_cntI; ++i)
-        Build_Connection(_integIDs[i]);
-    for(int i=0; i<_cntD; ++i)
-        Build_Connection(_delayIDs[i]);
-    for(int i=0; i<_cntO; ++i)
-        Build_Connection(_outIDs[i]);
+    std::vector<u8> added(_cntM, 0);
+    for (auto &ids: _integIDs) added[ids[0]] = 1;
+    for (auto &ids: _delayIDs) added[ids[0]] = 1;
+    for (auto &ids: _outIDs) added[ids[0]] = 1;
+    for(uint i=0; i<_cntI; ++i)
+        Build_Connection(_integIDs[i], added);
+    for(uint i=0; i<_cntD; ++i)
+        Build_Connection(_delayIDs[i], added);
+    for(uint i=0; i<_cntO; ++i)
+        Build_Connection(_outIDs[i], added);
+    for (PUnitModule m: _cooutputs)
+        if (!added[m->_id]) TRACELOG(LOG_FATAL, "Simucpp: Port \"%s\" isn't updated in simulation, "
+            "connect it to an OUTPUT module!", m->_name.c_str());
     if (_cntO==0) TRACELOG(LOG_WARNING, "Simucpp: You haven't add any OUTPUT modules.");
     TRACELOG(LOG_DEBUG, "Simucpp: Build sequence table completed.");
 
-    /* Index for discrete modules*/
+    /* Merge sequence tables of INTEGRATOR modules into one stage schedule */
+    Build_Stage();
+    TRACELOG(LOG_DEBUG, "Simucpp: Build stage schedule of %d modules completed.", (int)_stageIDs.size());
+
+    /* Index for discrete modules and build their event calendar */
     _discIDs.clear();
+    _trdIDs.clear();
+    _noiseIDs.clear();
     for (PUnitModule m: _modules) {
         if (m==nullptr) continue;
-        if (typeid(*m) == typeid(UZOH)) {
-            _discIDs.push_back(m->_id);
-        }
-        else if (typeid(*m) == typeid(UInput)) {
-            UInput* bm = (UInput*)m;
-            if (bm->_isc) continue;
-            _discIDs.push_back(m->_id);
+        if (typeid(*m) == typeid(UTransportDelay)) {
+            _trdIDs.push_back(m->_id);
+            ((UTransportDelay*)m)->Initialize(_H+_H);
         }
-        else if (typeid(*m) == typeid(UNoise)) {
-            UNoise* bm = (UNoise*)m;
-            if (bm->_T < 0) continue;
-            _discIDs.push_back(m->_id);
+        if (!m->_enable) continue;
+        if (Get_SampleTime(m) <= 0) {
+            if (typeid(*m) == typeid(UNoise)) _noiseIDs.push_back(m->_id);
+            continue;
         }
+        m->_enable = false;
+        _discIDs.push_back(m->_id);
     }
+    Schedule_Reset();
     TRACELOG(LOG_DEBUG, "Simucpp: Discrete modules indexing completed.");
+
+    /* Lower sequence tables into instruction tape */
+    Build_Tape();
+    if (_lanes > 1) {
+        if (!(_status & FLAG_TAPE)) TRACELOG(LOG_FATAL, "Simucpp: Ensemble mode requires the instruction tape!");
+        Build_Lanes();
+    }
+    if (_status & FLAG_JIT) Build_JIT();
+    TRACELOG(LOG_DEBUG, "Simucpp: Build instruction tape completed.");
     TRACELOG(LOG_INFO, "Simulator: Initialization successfully completed.");
+    Update_StoreTime();
     _status |= FLAG_INITIALIZED;
 }
 
@@ -203,130 +362,433 @@ int Simulator::Simulate() {
     return err;
 }
 int Simulator::Simulate_FirstStep() {
-    MODULE_INTEGRATOR_UPDATE();
+    if (!_params.empty()) Apply_Parameters();
+    Schedule_Update();
+    Stage_Update(_odeK[0]);
     MODULE_UNITDELAY_UPDATE();
     MODULE_OUTPUT_UPDATE();
-    if (_status & FLAG_STORE) _tvec.push_back(_t);
+    Schedule_Clear();
+    if (_storetime) Store_Time();
     return 0;
 }
 int Simulator::Simulate_FinalStep() {
-    MODULE_UNITDELAY_UPDATE_OUTPUT();
-    MODULE_INTEGRATOR_UPDATE();
+    if (!_params.empty()) Apply_Parameters();
+    Schedule_Update();
+    Stage_Update(_odeK[0]);
     MODULE_UNITDELAY_UPDATE();
     MODULE_OUTPUT_UPDATE();
-    if (_status & FLAG_STORE) _tvec.push_back(_t);
+    Schedule_Clear();
+    if (_storetime) Store_Time();
+    for (PUOutput m: _outputs)
+        if (m->_sink) m->_sink->Flush();
     return 0;
 }
 int Simulator::Simulate_OneStep() {
+    if (!_params.empty()) Apply_Parameters();
+    if (_status & FLAG_REALTIME) RealTime_Begin();
     if ((_status & FLAG_STORE) && (_t-_ltn >= _T-SIMUCPP_DBL_EPSILON)) {
         _ltn += _T;
-        _tvec.push_back(_t);
-    }
-    MODULE_UNITDELAY_UPDATE_OUTPUT();
-    for(int i=0; i<_cntI; ++i){
-        _outref[i] = _integrators[i]->_outvalue;
-        for (int j=_integIDs[i].size()-1; j>0; --j)
-            _modules[_integIDs[i][j]]->Module_Update(_t);
-        _ode4K[0][i] = _integrators[i]->Get_child()->Get_OutValue();
+        if (_storetime) Store_Time();
     }
+    Schedule_Update();
+    double *x = _outvalues.data();
+    for(uint i=0; i<_cntX; ++i)
+        _outref[i] = x[i];
+    Stage_Update(_odeK[0]);
     MODULE_UNITDELAY_UPDATE();
     MODULE_OUTPUT_UPDATE();
+    Schedule_Clear();
 
-    _t += _H;
-    SET_DISCRETE_ENABLE(false);
-    for(int i=0; i<_cntI; ++i)
-        _integrators[i]->_outvalue = _outref[i] + _H*_ode4K[0][i];
-    for(int i=0; i<_cntI; ++i){
-        for (int j=_integIDs[i].size()-1; j>0; --j)
-            _modules[_integIDs[i][j]]->Module_Update(_t);
-        _ode4K[1][i] = _integrators[i]->Get_child()->Get_OutValue();
-    }
-    for(int i=0; i<_cntI; ++i)
-        _integrators[i]->_outvalue = _outref[i] + _H*_ode4K[1][i];
-    for(int i=0; i<_cntI; ++i){
-        for (int j=_integIDs[i].size()-1; j>0; --j)
-            _modules[_integIDs[i][j]]->Module_Update(_t);
-        _ode4K[2][i] = _integrators[i]->Get_child()->Get_OutValue();
-    }
-
-    _t += _H;
-    for(int i=0; i<_cntI; ++i)
-        _integrators[i]->_outvalue = _outref[i] + (_H+_H)*_ode4K[2][i];
-    for(int i=0; i<_cntI; ++i){
-        for (int j=_integIDs[i].size()-1; j>0; --j)
-            _modules[_integIDs[i][j]]->Module_Update(_t);
-        _ode4K[3][i] = _integrators[i]->Get_child()->Get_OutValue();
-    }
-    for(int i=0; i<_cntI; ++i)
-        _integrators[i]->_outvalue = _outref[i] +
-            _H/3*(_ode4K[0][i] + _ode4K[1][i] + _ode4K[1][i] + _ode4K[2][i] + _ode4K[2][i] + _ode4K[3][i]);
-    SET_DISCRETE_ENABLE(true);
+    if (_solver == SOLVER_RK45) Solve_RK45();
+    else if (_solver == SOLVER_BDF2) Solve_BDF2();
+    else Solve_RK4();
+    _cntstep++;
+    if (_status & FLAG_REALTIME) RealTime_Pace();
 
     // Convergence and divergence check
     CHECK_CONVERGENCE(PUIntegrator, _integrators);
     CHECK_CONVERGENCE(PUUnitDelay, _unitdelays);
     CHECK_CONVERGENCE(PUOutput, _outputs);
+    for(uint i=_cntI; i<_cntX; ++i) {
+        if (x[i] > SIMUCPP_INFINITE1) return 1;
+        if (x[i] < -SIMUCPP_INFINITE1) return 2;
+        if (std::isnan(x[i])) return 3;
+    }
     return 0;
 }
 
 
+/**********************
+Merge the sequence tables of every INTEGRATOR modules into one stage schedule.
+Every sequence table is in topological order from back to front, and a module
+ shared by several tables only needs to be updated at its first appearance
+ because the tables are updated one after another. So the schedule is the
+ concatenation of the reversed tables without repetitive modules, and every
+ module is updated exactly once in every stage.
+Then the schedule is sorted by the level of modules, which is 1 plus the
+ largest level of their children in the schedule, so that modules of the same
+ level can be updated by different threads.
+**********************/
+void Simulator::Build_Stage() {
+    std::vector<u8> added(_cntM, 0);
+    std::vector<uint> level(_cntM, 0);
+    std::vector<uint> ids;
+    uint id, lvl, maxlvl = 0;
+    for(uint i=0; i<_cntI; ++i) {
+        for (int j=_integIDs[i].size()-1; j>0; --j) {
+            id = _integIDs[i][j];
+            if (added[id]) continue;
+            added[id] = 1;
+            ids.push_back(id);
+            lvl = 0;
+            for (uint c: _depends[id])
+                if (added[c]) lvl = SIMUCPP_MAX(lvl, level[c]);
+            level[id] = lvl + 1;
+            maxlvl = SIMUCPP_MAX(maxlvl, lvl + 1);
+        }
+    }
+    // Counting sort, which keeps the order of modules in the same level.
+    _stagelvl.assign(maxlvl+1, 0);
+    for (uint i: ids) _stagelvl[level[i]]++;
+    for (uint i=1; i<=maxlvl; ++i) _stagelvl[i] += _stagelvl[i-1];
+    _stageIDs.resize(ids.size());
+    for (int i=ids.size()-1; i>=0; --i)
+        _stageIDs[--_stagelvl[level[ids[i]]]] = ids[i];
+    // Now "_stagelvl[i]" is the offset of level "i+1", and level 0 is empty.
+    _stagelvl.erase(_stagelvl.begin());
+    _stagelvl.push_back(_stageIDs.size());
+    _stagederiv.clear();
+    for(uint i=0; i<_cntI; ++i)
+        _stagederiv.push_back(_integrators[i]->_next->_id);
+}
+void Simulator::Stage_Update(double *dx) {
+    if ((_status & FLAG_TAPE) && _jitfcn[0]) {
+        _jitfcn[0](_outvalues.data(), dx, this, Jit_Update, Jit_Fcn);
+        return;
+    }
+    if ((_status & FLAG_TAPE) && !_phaseseg.empty()) {
+        _pool->Run([&](uint w){ Stage_Work(w, dx, nullptr, 0); });
+        return;
+    }
+    if (_status & FLAG_TAPE)
+        Run_Tape(_tapeseg[0], _tapeseg[1], _tapebuf.data());
+    else for (uint id: _stageIDs)
+        Update_Module(id);
+    if (_lanes == 1) {
+        for(uint i=0; i<_cntI; ++i)
+            dx[i] = _outvalues[_stagederiv[i]];
+        return;
+    }
+    for(uint i=0; i<_cntI; ++i)
+        for (uint l=0; l<_lanes; ++l)
+            dx[i*_lanes+l] = _outvalues[_stagederiv[i]*_lanes+l];
+}
+void Simulator::Stage_Update(double *dx, const double *k, double h) {
+    double *x = _outvalues.data();
+    if ((_status & FLAG_TAPE) && !_phaseseg.empty() && !_jitfcn[0]) {
+        _pool->Run([&](uint w){ Stage_Work(w, dx, k, h); });
+        return;
+    }
+    for(uint i=0; i<_cntX; ++i)
+        x[i] = _outref[i] + h*k[i];
+    Stage_Update(dx);
+}
+
+
+/**********************
+Multithreaded stage.
+Every level of the stage schedule is either divided among threads, or merged
+ into the previous phase if it is smaller than 2*"_grain" and the previous
+ phase is updated by thread 0 alone. Threads wait at a barrier after every
+ phase. Updates of INTEGRATOR modules and their derivatives are divided evenly.
+**********************/
+void Simulator::Build_Phase() {
+    uint T = _threads, n, chunks, a, b;
+    uint *seg;
+    _phaseseg.clear();
+    if (T > 1) {
+        for (uint l=0; l+1<_tapelvl.size(); ++l) {
+            a = _tapelvl[l]; b = _tapelvl[l+1];
+            n = b - a;
+            chunks = SIMUCPP_MIN(T, n/SIMUCPP_MAX(_grain, 1u));
+            uint p = _phaseseg.size();
+            if (chunks >= 2) {
+                for (uint w=0; w<=T; ++w)
+                    _phaseseg.push_back(a + n*SIMUCPP_MIN(w, chunks)/chunks);
+                continue;
+            }
+            // "seg[1]==seg[T]" means the previous phase belongs to thread 0 alone.
+            seg = p ? &_phaseseg[p-T-1] : nullptr;
+            if (seg && (seg[1] == seg[T])) {
+                for (uint w=1; w<=T; ++w) seg[w] = b;
+                continue;
+            }
+            _phaseseg.push_back(a);
+            for (uint w=1; w<=T; ++w) _phaseseg.push_back(b);
+        }
+        // A single phase of thread 0 is the same as no threads.
+        if ((_phaseseg.size() == T+1) && (_phaseseg[1] == _phaseseg[T]))
+            _phaseseg.clear();
+    }
+    if (_phaseseg.empty()) T = 1;
+    if (_pool && (_pool->Get_Size() != T)) {
+        delete _pool; _pool = nullptr; }
+    if (!_pool && (T > 1)) _pool = new ThreadPool(T);
+    _tapebuf.resize(_tapebufw * T);
+}
+void Simulator::Stage_Work(uint w, double *dx, const double *k, double h) {
+    uint T = _pool->Get_Size(), L = _lanes;
+    uint i0 = _cntI*w/T, i1 = _cntI*(w+1)/T;
+    double *x = _outvalues.data();
+    double *buf = _tapebuf.data() + w*_tapebufw;
+    if (k) {
+        for (uint i=i0*L; i<i1*L; ++i)
+            x[i] = _outref[i] + h*k[i];
+        _pool->Barrier();
+    }
+    for (const uint *seg=_phaseseg.data(), *last=seg+_phaseseg.size(); seg!=last; seg+=T+1) {
+        Run_Tape(seg[w], seg[w+1], buf);
+        _pool->Barrier();
+    }
+    for (uint i=i0; i<i1; ++i)
+        for (uint l=0; l<L; ++l)
+            dx[i*L+l] = x[_stagederiv[i]*L+l];
+}
+
+
+/**********************
+Event calendar of discrete modules.
+"_hits" is a binary heap of the next sample hit of every discrete modules.
+At the beginning of a simulation step, only the modules whose sample hits
+ are due are popped and enabled, and they are disabled again after the
+ first stage. So the cost depends on the amount of sample hits instead of
+ the amount of discrete modules.
+**********************/
+void Simulator::Schedule_Reset() {
+    _hits.clear();
+    _fired.clear();
+    _due.assign(_cntM, 0);
+    for (int id: _discIDs) {
+        _modules[id]->_enable = false;
+        _hits.push_back(SampleHit{0, (uint)id});
+    }
+    std::make_heap(_hits.begin(), _hits.end());
+}
+void Simulator::Schedule_Update() {
+    PUnitModule m;
+    double T;
+    while (!_hits.empty() && (_hits.front().t <= _t+SIMUCPP_DBL_EPSILON)) {
+        std::pop_heap(_hits.begin(), _hits.end());
+        SampleHit &hit = _hits.back();
+        m = _modules[hit.id];
+        if (!_due[hit.id]) {
+            _due[hit.id] = 1;
+            m->_enable = true;
+            _fired.push_back(hit.id);
+            if (typeid(*m) == typeid(UUnitDelay)) ((PUUnitDelay)m)->Output_Update();
+        }
+        T = Get_SampleTime(m);
+        // Hits aren't removed, so the size of the heap doesn't change.
+        hit.t = T>0 ? hit.t+T : INFINITY;
+        std::push_heap(_hits.begin(), _hits.end());
+    }
+}
+void Simulator::Schedule_Clear() {
+    for (uint id: _fired) {
+        _due[id] = 0;
+        _modules[id]->_enable = false;
+    }
+    _fired.clear();
+}
+double Simulator::Get_SampleTime(PUnitModule m) {
+    if (typeid(*m) == typeid(UZOH)) return ((UZOH*)m)->_T;
+    if (typeid(*m) == typeid(UUnitDelay)) return ((UUnitDelay*)m)->_T;
+    if (typeid(*m) == typeid(UOutput)) return ((UOutput*)m)->_T;
+    if (typeid(*m) == typeid(UNoise)) return ((UNoise*)m)->_T;
+    if ((typeid(*m) == typeid(UInput)) && !((UInput*)m)->_isc) return ((UInput*)m)->_T;
+    return -1;
+}
+
+
+/**********************
+Lower the sequence tables into an instruction tape.
+Modules are visited in the same order as the stage schedule and the sequence
+ tables of UNITDELAY and OUTPUT modules, and SUM, GAIN, PRODUCT, FCN and
+ FCNMISO modules are translated into arithmetic instructions whose operands
+ are slots of "_outvalues". Other modules are kept as a call
+ of their virtual function "Module_Update()", and discrete modules are called
+ only at their sample hits. CONSTANT modules are skipped because their slots
+ already hold their output values.
+**********************/
+void Simulator::Build_Tape() {
+    _tape.clear(); _tapeargs.clear(); _tapegains.clear();
+    _tapebuf.clear();
+    _tapeseg[0] = 0;
+    _tapelvl.clear();
+    for (uint l=0; l+1<_stagelvl.size(); ++l) {
+        _tapelvl.push_back(_tape.size());
+        for (uint i=_stagelvl[l]; i<_stagelvl[l+1]; ++i)
+            Build_Tape(_stageIDs[i]);
+    }
+    _tapelvl.push_back(_tape.size());
+    _tapeseg[1] = _tape.size();
+    for(uint i=0; i<_cntD; ++i)
+        Build_Tape(_delayIDs[i], 0);
+    _tapeseg[2] = _tape.size();
+    for(uint i=0; i<_cntO; ++i)
+        Build_Tape(_outIDs[i], 0);
+    _tapeseg[3] = _tape.size();
+    _linear.clear();
+    _cntlinear = 0;
+    if (_status & FLAG_LINEAR) Build_Linear();
+    _tapebufw = _tapebuf.size();
+    Build_Phase();
+}
+void Simulator::Build_Tape(std::vector<uint> &ids, int end) {
+    for (int j=ids.size()-1; j>=end; --j)
+        Build_Tape(ids[j]);
+}
+void Simulator::Build_Tape(uint id) {
+    TapeCode code;
+    PUnitModule m = _modules[id];
+    code.dst = m->_id;
+    code.arg = _tapeargs.size();
+    code.cnt = 0;
+    code.m = m;
+    if (_loopidx[id] >= 0) {
+        code.op = TAPE_LOOP;
+        code.arg = _loopidx[id];
+        _tape.push_back(code);
+        return;
+    }
+    if (typeid(*m) == typeid(USum)) {
+        USum *mdl = (USum*)m;
+        if (!mdl->_enable) return;
+        code.op = TAPE_SUM;
+        for (uint k=0; k<mdl->_next.size(); ++k) {
+            _tapeargs.push_back(mdl->_next[k]->_id);
+            _tapegains.push_back(mdl->_ingain[k]);
+        }
+    }
+    else if (typeid(*m) == typeid(UGain)) {
+        UGain *mdl = (UGain*)m;
+        if (!mdl->_enable) return;
+        code.op = TAPE_GAIN;
+        _tapeargs.push_back(mdl->_next->_id);
+        _tapegains.push_back(mdl->_gain);
+    }
+    else if (typeid(*m) == typeid(UProduct)) {
+        UProduct *mdl = (UProduct*)m;
+        if (!mdl->_enable) return;
+        code.op = TAPE_PRODUCT;
+        for (uint k=0; k<mdl->_next.size(); ++k) {
+            _tapeargs.push_back(mdl->_next[k]->_id);
+            _tapegains.push_back(mdl->_ingain[k]);
+        }
+    }
+    else if (typeid(*m) == typeid(UFcn)) {
+        UFcn *mdl = (UFcn*)m;
+        if (!mdl->_enable) return;
+        code.op = TAPE_FCN;
+        _tapeargs.push_back(mdl->_next->_id);
+        _tapegains.push_back(1);
+    }
+    else if (typeid(*m) == typeid(UFcnMISO)) {
+        UFcnMISO *mdl = (UFcnMISO*)m;
+        if (!mdl->_enable) return;
+        code.op = TAPE_FCNMISO;
+        for (uint k=0; k<mdl->_next.size(); ++k) {
+            _tapeargs.push_back(mdl->_next[k]->_id);
+            _tapegains.push_back(1);
+        }
+        if (_tapebuf.size() < mdl->_next.size())
+            _tapebuf.resize(mdl->_next.size());
+    }
+    else if (typeid(*m) == typeid(UConstant)) {
+        return;
+    }
+    else {
+        code.op = m->_enable ? TAPE_UPDATE : TAPE_DISCRETE;
+    }
+    code.cnt = _tapeargs.size() - code.arg;
+    _tape.push_back(code);
+}
+void Simulator::Run_Tape(uint begin, uint end, double *buf) {
+    if (_lanes > 1) { Run_Lanes(begin, end, buf); return; }
+    double *v = _outvalues.data();
+    const uint *args = _tapeargs.data();
+    const double *gains = _tapegains.data();
+    double ans;
+    for (const TapeCode *code=_tape.data()+begin, *last=_tape.data()+end; code!=last; ++code) {
+        const uint *a = args + code->arg;
+        const double *g = gains + code->arg;
+        switch (code->op) {
+        case TAPE_SUM:
+            ans = 0;
+            for (int k=code->cnt-1; k>=0; --k)
+                ans += g[k] * v[a[k]];
+            break;
+        case TAPE_GAIN:
+            ans = g[0] * v[a[0]];
+            break;
+        case TAPE_PRODUCT:
+            ans = 1;
+            for (int k=code->cnt-1; k>=0; --k)
+                ans *= g[k] * v[a[k]];
+            break;
+        case TAPE_FCN:
+            ans = ((UFcn*)code->m)->_f(v[a[0]]);
+            break;
+        case TAPE_FCNMISO:
+            for (uint k=0; k<code->cnt; ++k)
+                buf[k] = v[a[k]];
+            ans = ((UFcnMISO*)code->m)->_f(buf);
+            break;
+        case TAPE_DISCRETE:
+            if (_due[code->dst]) code->m->Module_Update(_t);
+            continue;
+        case TAPE_LINEAR:
+            Run_Linear(_linear[code->arg]);
+            continue;
+        case TAPE_LOOP:
+            Solve_Loop(_loops[code->arg]);
+            continue;
+        default:
+            code->m->Module_Update(_t);
+            continue;
+        }
+        v[code->dst] = ans;
+    }
+}
+
+
 /**********************
 ids: IDs of every Endpoint modules.
 The input is a sequence table and has only one element, and this function
- build the connection accroding to the modules' children modules and add
- them to that sequence table and return it.
+ adds the modules which it depends on by a depth-first search of "_depends",
+ so the sequence table is in reversed post order and every module is in front
+ of the modules it reads. Modules of previous sequence tables are marked in
+ "added" and skipped, so building all sequence tables runs in O(V+E).
 **********************/
-void Simulator::Build_Connection(std::vector<uint> &ids) {
-    std::stack<uint> idq;  // ids in stack
-    std::vector<uint> idqv;  // compare in idq
-    int id;  // id of child module
-    int curid;  // id of module in top of stack
-    bool equal = false;  // if repetitive id detected
-    PUnitModule bm;  // pointer to child module
-    idq.push(ids[0]); idqv.push_back(ids[0]);
-    while (!idq.empty()){
-        curid = idq.top(); idq.pop(); idqv.pop_back();
-        for (int i=0; i<_modules[curid]->Get_childCnt(); ++i){
-            bm = _modules[curid]->Get_child(i);
-            if (bm==nullptr) continue;
-            id = bm->_id;
-            if (id<0) TRACELOG(LOG_FATAL, "Simucpp: internal error: connection.");
-            if (typeid(*bm) == typeid(UIntegrator)) continue;
-            if (typeid(*bm) == typeid(UUnitDelay)) continue;
-            for (int j=0; j<(int)_discIDs.size(); ++j){
-                if (_discIDs[j] != id) continue;
-                std::stack<int> agq;  // ids in another stack
-                agq.push(id);
-                while (!agq.empty()){
-                    int agcurid = agq.top(); agq.pop();
-                    for (int k=0; k<_modules[agcurid]->Get_childCnt(); ++k){
-                        bm = _modules[agcurid]->Get_child(k);
-                        if (bm==nullptr) continue;
-                        if (typeid(*bm) == typeid(UIntegrator)) continue;
-                        if (typeid(*bm) == typeid(UUnitDelay)) continue;
-                        int agid = bm->_id;
-                        if (agid==curid) {
-                            Print_Connection(ids);
-                            TRACELOG(LOG_FATAL, "Simucpp: Algebraic loop detected!");
-                        }
-                        agq.push(agid);
-                    }
-                }
-                if (Find_vector(ids, id)) {
-                    std::remove(std::begin(ids), std::end(ids), id);
-                    ids.pop_back(); }
-                else {
-                    equal = true; }
-                break;
-            }
-            if (equal) {
-                equal=false; continue; }
-            ids.push_back(id);
-            _discIDs.push_back(id);
-            if (!Find_vector(idqv, id)) {
-                idq.push(id);idqv.push_back(id); }
+void Simulator::Build_Connection(std::vector<uint> &ids, std::vector<u8> &added) {
+    std::vector<std::pair<uint, uint>> call;  // Module and index of its next child
+    std::vector<uint> post;  // Modules in post order
+    uint id, c;
+    call.push_back(std::make_pair(ids[0], 0u));
+    while (!call.empty()) {
+        id = call.back().first;
+        if (call.back().second < _depends[id].size()) {
+            c = _depends[id][call.back().second++];
+            if (added[c]) continue;
+            added[c] = 1;
+            call.push_back(std::make_pair(c, 0u));
+            continue;
         }
+        call.pop_back();
+        post.push_back(id);
     }
+    post.pop_back();  // The Endpoint module itself
+    ids.insert(ids.end(), post.rbegin(), post.rend());
 }
 
 
@@ -334,14 +796,50 @@ void Simulator::Build_Connection(std::vector<uint> &ids) {
 Reset all modules of this simulation to their initial state.
 **********************/
 void Simulator::Simulation_Reset() {
-     _t = 0; _tvec.clear();
+     if (!_params.empty()) Apply_Parameters();
+     _t = 0; _tvec.clear(); _tpacked.Clear(); _tring.Clear();
      _ltn = -_T;
+     Schedule_Reset();
+     _hstep = _H+_H;
+     _cntstep = _cntreject = 0;
+     _hasprev = false;
     for(PUnitModule m:_modules) {
         if (m==nullptr) continue;
         m->Module_Reset();
     }
+    if ((_lanes > 1) && (_status & FLAG_INITIALIZED)) Reset_Lanes();
+    Reset_RealTime();
+    Update_StoreTime();
     _status &=~ FLAG_DIVERGED;
 }
+// Time points are only stored for OUTPUT modules storing data to memory, and
+//  they are limited only if all of those modules are limited.
+void Simulator::Update_StoreTime() {
+    bool limited = true;
+    _storetime = false;
+    _tmax = 0;
+    for (PUOutput m: _outputs) {
+        if (!(_status & FLAG_STORE) || !m->_store || m->_sink) continue;
+        _storetime = true;
+        if (m->_maxstorage > 0) _tmax = SIMUCPP_MAX(_tmax, (size_t)m->_maxstorage);
+        else limited = false;
+    }
+    if (!limited) _tmax = 0;
+    _tring.Set_Capacity(_status & FLAG_COMPRESS ? 0 : _tmax);
+}
+void Simulator::Store_Time() {
+    if (_status & FLAG_COMPRESS) {
+        _tpacked.Push(_t);
+        if (_tmax && (_tpacked.Size() > _tmax)) _tpacked.Drop_Front(1);
+    }
+    else if (_tmax) _tring.Push(_t);
+    else _tvec.push_back(_t);
+}
+std::vector<double>& Simulator::Get_TimeData() {
+    if (_status & FLAG_COMPRESS) _tpacked.Decode(_tvec);
+    else if (_tmax) _tring.Copy(_tvec);
+    return _tvec;
+}
 /**********************
 Use data stored in OUTPUT modules to draw a waveform.
 **********************/
@@ -352,14 +850,17 @@ void Simulator::Plot() {
     if (_outputs.size() < 1)
         TRACELOG(LOG_FATAL, "Simucpp plot: No output data for plot!");
     for (PUOutput m: _outputs) {
-        if (!m->_store) continue;
-        if (m->_values.size() < 3)
+        if (!m->_store || m->_sink) continue;
+        std::vector<double> &tvec = Get_TimeData(), &values = m->Get_StoredData();
+        if (values.size() < 3)
             TRACELOG(LOG_FATAL, "Simucpp plot: Module \"%s\" has too few data points to plot!"
-            "data points: %d.", m->_name.c_str(), m->_values.size());
-        if (_tvec.size()!=m->_values.size())
+            "data points: %d.", m->_name.c_str(), values.size());
+        if (tvec.size() < values.size())
             TRACELOG(LOG_FATAL, "Simucpp plot: Module \"%s\" has a wrong data amount for plotting!"
-            "Time points:%d; data points:%d.", m->_name.c_str(), _tvec.size(), m->_values.size());
-        matplotlibcpp::named_plot(m->_name, _tvec, m->_values);
+            "Time points:%d; data points:%d.", m->_name.c_str(), tvec.size(), values.size());
+        // Limited data are the latest ones.
+        std::vector<double> t(tvec.end()-values.size(), tvec.end());
+        matplotlibcpp::named_plot(m->_name, t, values);
     }
     matplotlibcpp::legend();
     matplotlibcpp::show();
@@ -374,7 +875,6 @@ Print connection information.
 void Simulator::Print_Modules() {
 #if defined(SUPPORT_DEBUG)
     using namespace std;
-    int childcnt;
     PUnitModule bm;  // pointer to child module
     cout << "Model structure print start." << endl;
     for (PUnitModule m: _modules) {
@@ -404,7 +904,13 @@ void Simulator::Print_Modules() {
 void Simulator::Set_EnableStore(bool store) {
     if (store) _status |= FLAG_STORE;
     else _status &=~ FLAG_STORE;
-    for (PUOutput m: _outputs) m->Set_EnableStore(store);}
+    for (PUOutput m: _outputs) m->Set_EnableStore(store);
+    Update_StoreTime(); }
+void Simulator::Set_EnableCompress(bool compress) {
+    if (compress) _status |= FLAG_COMPRESS;
+    else _status &=~ FLAG_COMPRESS;
+    for (PUOutput m: _outputs) m->Set_EnableCompress(compress);
+    Update_StoreTime(); }
 void Simulator::Set_SampleTime(double time) { _T=time;_ltn=-_T;
     for (PUOutput m: _outputs) m->Set_SampleTime(time); }
 void Simulator::Set_t(double t) { _t = t; }
@@ -414,5 +920,21 @@ double Simulator::Get_Endtime() { return _endtime; }
 void Simulator::Set_SimStep(double step) { _H=0.5*step; }
 double Simulator::Get_SimStep() { return _H+_H; }
 void Simulator::Set_DivergenceCheckMode(int mode) { _divmode=mode; };
+void Simulator::Set_Solver(int solver) { _solver=solver; }
+void Simulator::Set_Tolerance(double reltol, double abstol) { _reltol=reltol;_abstol=abstol; }
+void Simulator::Set_MaxStep(double step) { _hmax=step; }
+uint Simulator::Get_StepCount(bool rejected) { return rejected?_cntreject:_cntstep; }
+uint Simulator::Get_JacobianCount() { return _cntjacob; }
+uint Simulator::Get_StageCount() {
+    if (_status & FLAG_TAPE) return _tapeseg[1] - _tapeseg[0];
+    return _stageIDs.size(); }
+void Simulator::Set_EnableTape(bool tape) {
+    if (tape) _status |= FLAG_TAPE;
+    else _status &=~ FLAG_TAPE; }
+void Simulator::Set_Threads(uint threads, uint grain) {
+    _threads = threads<1 ? 1 : threads;
+    _grain = grain;
+    if (_status & FLAG_INITIALIZED) Build_Phase();
+}
 
 NAMESPACE_SIMUCPP_R
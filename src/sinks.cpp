@@ -0,0 +1,133 @@
+#include "sinks.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+MEMORY sink.
+**********************/
+void MemorySink::Write(double t, double v) { _t.push_back(t); _v.push_back(v); }
+void MemorySink::Reset() { _t.clear(); _v.clear(); }
+std::vector<double>& MemorySink::Get_Time() { return _t; }
+std::vector<double>& MemorySink::Get_Data() { return _v; }
+
+
+/**********************
+STREAM sink.
+**********************/
+StreamSink::StreamSink(uint chunk, uint chunks) {
+    _size = chunk<1 ? 1 : chunk;
+    _chunks.resize(chunks<1 ? 1 : chunks);
+    for (std::vector<double> &c: _chunks) c.resize(2*_size);
+    for (uint i=_chunks.size()-1; i>0; --i) _free.push_back(i);
+    _cur = _n = 0;
+    _busy = _quit = _drop = false;
+    _thread = std::thread(&StreamSink::Work, this);
+}
+/**********************
+The derived object has been destroyed here, so "Consume()" can't be called,
+ and the background thread is stopped without consuming the rest of samples.
+**********************/
+StreamSink::~StreamSink() {
+    if (!_thread.joinable()) return;
+    uint dropped = _n;
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        for (const std::pair<uint, uint> &c: _full) dropped += c.second;
+        _full.clear();
+        _quit = _drop = true;
+    }
+    _cvwork.notify_one();
+    _thread.join();
+    if (dropped) TRACELOG(LOG_WARNING, "StreamSink: %d samples are dropped, because the sink isn't closed "
+        "by its derived class.", dropped);
+}
+void StreamSink::Write(double t, double v) {
+    if (_n == _size) Submit();
+    double *p = _chunks[_cur].data() + 2*_n++;
+    p[0] = t; p[1] = v;
+}
+void StreamSink::Flush() {
+    if (_n > 0) Submit();
+    std::unique_lock<std::mutex> lock(_mtx);
+    _cvdone.wait(lock, [this]{ return _full.empty() && !_busy; });
+}
+void StreamSink::Reset() { Flush(); }
+void StreamSink::Close() {
+    if (!_thread.joinable()) return;
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _quit = true;
+    }
+    _cvwork.notify_one();
+    _thread.join();
+}
+void StreamSink::Submit() {
+    std::unique_lock<std::mutex> lock(_mtx);
+    _full.push_back(std::make_pair(_cur, _n));
+    _cvwork.notify_one();
+    _cvdone.wait(lock, [this]{ return !_free.empty(); });
+    _cur = _free.back();
+    _free.pop_back();
+    _n = 0;
+}
+void StreamSink::Work() {
+    std::unique_lock<std::mutex> lock(_mtx);
+    while (true) {
+        _cvwork.wait(lock, [this]{ return _quit || !_full.empty(); });
+        if (_full.empty() || _drop) return;
+        std::pair<uint, uint> c = _full.front();
+        _full.pop_front();
+        _busy = true;
+        lock.unlock();
+        Consume(_chunks[c.first].data(), c.second);
+        lock.lock();
+        _busy = false;
+        _free.push_back(c.first);
+        _cvdone.notify_all();
+    }
+}
+
+
+/**********************
+FILE sink.
+**********************/
+FileSink::FileSink(std::string filename, uint chunk, uint chunks)
+    : StreamSink(chunk, chunks), _filename(filename)
+{
+    _file = fopen(filename.c_str(), "wb");
+    if (!_file) TRACELOG(LOG_WARNING, "FileSink: File \"%s\" can't be opened.", filename.c_str());
+}
+FileSink::~FileSink() {
+    Close();
+    if (_file) fclose(_file);
+}
+void FileSink::Flush() {
+    StreamSink::Flush();
+    if (_file) fflush(_file);
+}
+void FileSink::Reset() {
+    Flush();
+    if (_file) fclose(_file);
+    _file = fopen(_filename.c_str(), "wb");
+    if (!_file) TRACELOG(LOG_WARNING, "FileSink: File \"%s\" can't be opened.", _filename.c_str());
+}
+void FileSink::Consume(const double *data, uint n) {
+    if (!_file) return;
+    if (fwrite(data, 2*sizeof(double), n, _file) != n)
+        TRACELOG(LOG_WARNING, "FileSink: Failed to write file \"%s\".", _filename.c_str());
+}
+
+
+/**********************
+CALLBACK sink.
+**********************/
+CallbackSink::CallbackSink(std::function<void(const double*, uint)> function, uint chunk, uint chunks)
+    : StreamSink(chunk, chunks), _f(function)
+{
+    if (!function) TRACELOG(LOG_FATAL, "CallbackSink: The function is empty!");
+}
+CallbackSink::~CallbackSink() { Close(); }
+void CallbackSink::Consume(const double *data, uint n) { _f(data, n); }
+
+NAMESPACE_SIMUCPP_R
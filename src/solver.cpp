@@ -0,0 +1,234 @@
+#include <cmath>
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+enum JACOBIAN_FLAG {
+    JACOB_UPDATED     = 0x01,   // Set when the Jacobian is evaluated
+    JACOB_FACTORIZED  = 0x02,   // Set when the iteration matrix is factorized
+};
+
+/**********************
+LU decomposition with partial pivoting of a n*n matrix "a" in place.
+Return false if "a" is singular.
+**********************/
+bool LU_Decompose(double *a, int *piv, int n) {
+    int p;
+    double big, tmp;
+    for (int k=0; k<n; ++k) {
+        p = k; big = fabs(a[k*n+k]);
+        for (int i=k+1; i<n; ++i)
+            if (fabs(a[i*n+k]) > big) { big = fabs(a[i*n+k]); p = i; }
+        piv[k] = p;
+        if (big == 0) return false;
+        if (p != k)
+            for (int j=0; j<n; ++j) { tmp = a[k*n+j]; a[k*n+j] = a[p*n+j]; a[p*n+j] = tmp; }
+        for (int i=k+1; i<n; ++i) {
+            a[i*n+k] /= a[k*n+k];
+            for (int j=k+1; j<n; ++j)
+                a[i*n+j] -= a[i*n+k] * a[k*n+j];
+        }
+    }
+    return true;
+}
+// Solve "ax=b" in place by the result of "LU_Decompose".
+void LU_Solve(const double *a, const int *piv, int n, double *b) {
+    double tmp;
+    for (int k=0; k<n; ++k) {
+        if (piv[k] != k) { tmp = b[k]; b[k] = b[piv[k]]; b[piv[k]] = tmp; }
+        for (int i=k+1; i<n; ++i)
+            b[i] -= a[i*n+k] * b[k];
+    }
+    for (int i=n-1; i>=0; --i) {
+        for (int j=i+1; j<n; ++j)
+            b[i] -= a[i*n+j] * b[j];
+        b[i] /= a[i*n+i];
+    }
+}
+
+
+/**********************
+Fixed-step 4-order Runge-Kutta algorithm.
+"_odeK[0]" has been evaluated at the beginning of this step.
+**********************/
+void Simulator::Solve_RK4() {
+    double *x = _outvalues.data();
+    _t += _H;
+    Stage_Update(_odeK[1], _odeK[0], _H);
+    Stage_Update(_odeK[2], _odeK[1], _H);
+
+    _t += _H;
+    Stage_Update(_odeK[3], _odeK[2], _H+_H);
+    for(uint i=0; i<_cntX; ++i)
+        x[i] = _outref[i] +
+            _H/3*(_odeK[0][i] + _odeK[1][i] + _odeK[1][i] + _odeK[2][i] + _odeK[2][i] + _odeK[3][i]);
+}
+
+
+/**********************
+Variable-step Dormand-Prince 5(4) algorithm.
+"_odeK[0]" has been evaluated at the beginning of this step. The step is
+ clamped to the end time and the next sample hit of discrete modules, and
+ it is rejected and retried with a smaller step if the local error estimated
+ by the embedded 4-order solution exceeds the tolerances.
+**********************/
+void Simulator::Solve_RK45() {
+    static const double c[7] = {0, 1.0/5, 3.0/10, 4.0/5, 8.0/9, 1, 1};
+    static const double a[7][6] = {
+        {0},
+        {1.0/5},
+        {3.0/40, 9.0/40},
+        {44.0/45, -56.0/15, 32.0/9},
+        {19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729},
+        {9017.0/3168, -355.0/33, 46732.0/5247, 49.0/176, -5103.0/18656},
+        {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84},
+    };
+    // Difference between the 5-order and the embedded 4-order weights.
+    static const double e[7] = {71.0/57600, 0, -71.0/16695, 71.0/1920,
+        -17253.0/339200, 22.0/525, -1.0/40};
+    double *x = _outvalues.data();
+    double t0 = _t, hmax, h, err, sc, ans, fac;
+    bool rejected = false;
+    hmax = _endtime - t0;
+    if ((_hmax > 0) && (_hmax < hmax)) hmax = _hmax;
+    hmax = SIMUCPP_MIN(hmax, Next_SampleHit() - t0);
+    h = SIMUCPP_MIN(_hstep, hmax);
+    while (true) {
+        for (int s=1; s<7; ++s) {
+            for(uint i=0; i<_cntX; ++i) {
+                ans = 0;
+                for (int k=0; k<s; ++k) ans += a[s][k]*_odeK[k][i];
+                x[i] = _outref[i] + h*ans;
+            }
+            _t = t0 + c[s]*h;
+            Stage_Update(_odeK[s]);
+        }
+        err = 0;
+        for(uint i=0; i<_cntX; ++i) {
+            ans = 0;
+            for (int k=0; k<7; ++k) ans += e[k]*_odeK[k][i];
+            sc = _abstol + _reltol*SIMUCPP_MAX(fabs(_outref[i]), fabs(x[i]));
+            err += (h*ans/sc) * (h*ans/sc);
+        }
+        err = _cntX>0 ? sqrt(err/_cntX) : 0;
+        if ((err <= 1) || (h <= SIMUCPP_RK45_MINSTEP)) break;
+        _cntreject++;
+        rejected = true;
+        h = SIMUCPP_MAX(h*SIMUCPP_MAX(0.2, 0.9*pow(err, -0.2)), SIMUCPP_RK45_MINSTEP);
+    }
+    // "x" has been the 5-order solution since the last stage.
+    _t = t0 + h;
+    fac = err>0 ? SIMUCPP_LIMIT(0.9*pow(err, -0.2), 0.2, 5.0) : 5.0;
+    if (rejected) fac = SIMUCPP_MIN(fac, 1.0);
+    // A step clamped by the end time or sample hits doesn't shrink the next step.
+    if (!rejected && (hmax < _hstep)) _hstep = SIMUCPP_MAX(h*fac, _hstep);
+    else _hstep = h*fac;
+}
+double Simulator::Next_SampleHit() {
+    double hit = _endtime;
+    if ((_status & FLAG_STORE) && (_T > 0)) hit = _ltn + _T;
+    // Due sample hits have been popped by "Schedule_Update" in this step.
+    if (!_hits.empty()) hit = SIMUCPP_MIN(hit, _hits.front().t);
+    // Output of a TRANSPORTDELAY module in a step only depends on its stored
+    //  input values if the step isn't longer than its delay time, which may be
+    //  as short as one simulation step if the delay time is an input.
+    for (uint id: _trdIDs) {
+        UTransportDelay *m = (UTransportDelay*)_modules[id];
+        hit = SIMUCPP_MIN(hit, _t + (m->_delayin ? m->_simstep : SIMUCPP_MAX(m->_delay, m->_simstep)));
+    }
+    return hit;
+}
+
+
+/**********************
+Fixed-step implicit 2-order backward differentiation formula:
+ x(n+1) - 4/3*x(n) + 1/3*x(n-1) = 2/3*h*f(t(n+1), x(n+1))
+The first step after initialization or reset is a backward Euler step.
+The nonlinear equation is solved by Newton iterations with the matrix
+ "I-gamma*h*J", where "J" is a finite-difference Jacobian of derivatives of
+ INTEGRATOR modules. "J" and its factorization are reused across steps, and
+ they are updated only when the iterations converge slowly or diverge.
+**********************/
+void Simulator::Solve_BDF2() {
+    double *x = _outvalues.data();
+    double *f = _odeK[1], *dx = _odeK[2], *psi = _odeK[3];
+    double t0 = _t, h = _H+_H, gh, nrm, nrm0;
+    bool converged = false, fresh = false;
+    bool bdf2 = _hasprev;
+    if (_cntX == 0) { _t = t0 + h; return; }
+    gh = bdf2 ? h*2/3 : h;
+    for(uint i=0; i<_cntX; ++i)
+        psi[i] = bdf2 ? (4*_outref[i] - _xprev[i])/3 : _outref[i];
+    while (true) {
+        if (!(_jacobstate & JACOB_UPDATED)) {
+            _t = t0;
+            Jacobian_Update();
+            fresh = true;
+        }
+        if (!(_jacobstate & JACOB_FACTORIZED) || (_jacobgh != gh)) {
+            _jacoblu.resize(_cntX*_cntX);
+            _jacobpiv.resize(_cntX);
+            for(uint i=0; i<_cntX; ++i)
+                for(uint j=0; j<_cntX; ++j)
+                    _jacoblu[i*_cntX+j] = (i==j ? 1 : 0) - gh*_jacob[i*_cntX+j];
+            if (!LU_Decompose(_jacoblu.data(), _jacobpiv.data(), _cntX))
+                TRACELOG(LOG_FATAL, "Simucpp: Iteration matrix of BDF2 is singular at time %f.", t0);
+            _jacobstate |= JACOB_FACTORIZED;
+            _jacobgh = gh;
+        }
+        // Explicit Euler predictor
+        for(uint i=0; i<_cntX; ++i)
+            x[i] = _outref[i] + h*_odeK[0][i];
+        _t = t0 + h;
+        nrm0 = 0;
+        for (int iter=0; iter<SIMUCPP_NEWTON_MAXITER; ++iter) {
+            Stage_Update(f);
+            for(uint i=0; i<_cntX; ++i)
+                dx[i] = psi[i] + gh*f[i] - x[i];
+            LU_Solve(_jacoblu.data(), _jacobpiv.data(), _cntX, dx);
+            nrm = 0;
+            for(uint i=0; i<_cntX; ++i) {
+                x[i] += dx[i];
+                nrm += pow(dx[i] / (_abstol + _reltol*fabs(x[i])), 2);
+            }
+            nrm = sqrt(nrm/_cntX);
+            if (nrm <= SIMUCPP_NEWTON_TOL) { converged = true; break; }
+            if ((iter>0) && (nrm > 0.9*nrm0)) break;
+            nrm0 = nrm;
+        }
+        if (converged || fresh) break;
+        _jacobstate = 0;
+    }
+    if (!converged)
+        TRACELOG(LOG_WARNING, "Simucpp: Newton iterations of BDF2 didn't converge at time %f.", t0);
+    _xprev.resize(_cntX);
+    std::copy(_outref.begin(), _outref.end(), _xprev.begin());
+    _hasprev = true;
+    _t = t0 + h;
+}
+/**********************
+Finite-difference Jacobian of derivatives of INTEGRATOR modules at the
+ beginning of this step, whose derivatives have been saved to "_odeK[0]".
+"_jacob" is a row-major matrix and "_jacob[i*n+j]" is d(dx[i])/d(x[j]).
+**********************/
+void Simulator::Jacobian_Update() {
+    double *x = _outvalues.data();
+    double *f = _odeK[4];
+    double delta;
+    _jacob.resize(_cntX*_cntX);
+    _jacobpiv.resize(_cntX);
+    for(uint i=0; i<_cntX; ++i)
+        x[i] = _outref[i];
+    for(uint j=0; j<_cntX; ++j) {
+        delta = SIMUCPP_JACOBIAN_DELTA * SIMUCPP_MAX(fabs(_outref[j]), 1.0);
+        x[j] = _outref[j] + delta;
+        Stage_Update(f);
+        x[j] = _outref[j];
+        for(uint i=0; i<_cntX; ++i)
+            _jacob[i*_cntX+j] = (f[i] - _odeK[0][i]) / delta;
+    }
+    _jacobstate = JACOB_UPDATED;
+    _cntjacob++;
+}
+
+NAMESPACE_SIMUCPP_R
@@ -0,0 +1,139 @@
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include "simulator.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Stream buffer which appends characters to a blob, or reads them from a part
+ of a blob, so that streaming doesn't allocate memory except for growing
+ the blob.
+**********************/
+struct BlobBuffer: public std::streambuf {
+    std::vector<u8> *out;
+    BlobBuffer(std::vector<u8> *blob): out(blob) {}
+    BlobBuffer(const u8 *in, size_t n): out(nullptr) { setg((char*)in, (char*)in, (char*)in+n); }
+    virtual int_type overflow(int_type c) override {
+        if (c != traits_type::eof()) out->push_back((u8)c);
+        return traits_type::not_eof(c);
+    }
+    virtual std::streamsize xsputn(const char *s, std::streamsize n) override {
+        out->insert(out->end(), (const u8*)s, (const u8*)s+n);
+        return n;
+    }
+};
+
+/**********************
+Writer or reader of a state blob, so that the same function saves and
+ restores a state. Values are copied by their bytes, and a vector is saved
+ as its length and elements. Sizes of vectors are fixed after initialization
+ and checked when they're restored, so restoring doesn't allocate memory.
+Random number engines aren't trivially copyable, so they're saved by their
+ stream operators as their length and text.
+**********************/
+struct StateBlob {
+    std::vector<u8> *out;  // Blob to write, or nullptr to read from "in".
+    const u8 *in, *end;
+    void Bytes(void *p, size_t n) {
+        if (out) { out->insert(out->end(), (const u8*)p, (const u8*)p+n); return; }
+        if (in+n > end) TRACELOG(LOG_FATAL, "Simulator: The state blob is truncated!");
+        memcpy(p, in, n); in += n;
+    }
+    template<typename T> void Value(T &v) { Bytes(&v, sizeof(T)); }
+    template<typename T> void Vector(std::vector<T> &v) {
+        uint n = v.size();
+        Value(n);
+        if (n != v.size()) TRACELOG(LOG_FATAL, "Simulator: The state blob doesn't match this simulator!");
+        if (n) Bytes(v.data(), n*sizeof(T));
+    }
+    void Engine(std::mt19937 &rng) {
+        uint n = 0;
+        if (out) {
+            size_t pos = out->size();
+            Value(n);
+            BlobBuffer buf(out);
+            std::ostream os(&buf);
+            os << rng;
+            n = out->size() - pos - sizeof(n);
+            memcpy(out->data()+pos, &n, sizeof(n));
+            return;
+        }
+        Value(n);
+        if (in+n > end) TRACELOG(LOG_FATAL, "Simulator: The state blob is truncated!");
+        BlobBuffer buf(in, n);
+        std::istream is(&buf);
+        is >> rng;
+        if (is.fail()) TRACELOG(LOG_FATAL, "Simulator: The state blob doesn't match this simulator!");
+        in += n;
+    }
+};
+
+void Simulator::Module_State(PUnitModule m, StateBlob &blob) {
+    if (typeid(*m) == typeid(UInput)) blob.Value(((UInput*)m)->_cnt);
+    else if (typeid(*m) == typeid(UNoise)) blob.Engine(((UNoise*)m)->_rng);
+    else if (typeid(*m) == typeid(UUnitDelay)) blob.Value(((UUnitDelay*)m)->_lv);
+    else if (typeid(*m) == typeid(UTransportDelay)) {
+        UTransportDelay *mdl = (UTransportDelay*)m;
+        blob.Vector(mdl->_lv._buf);
+        blob.Value(mdl->_lv._head); blob.Value(mdl->_lv._size);
+        blob.Value(mdl->_nexttime);
+    }
+}
+
+/**********************
+Save or restore the state of this simulator and its modules.
+The blob begins with the sizes of this simulator, which are checked when it's
+ restored. Caches which don't change results, such as Jacobians of algebraic
+ loops, aren't saved.
+**********************/
+void Simulator::Transfer_State(StateBlob &blob) {
+    uint head[4] = {SIMUCPP_STATE_MAGIC, _cntM, _cntX, _lanes}, check[4];
+    for (int i=0; i<4; ++i) check[i] = head[i];
+    for (int i=0; i<4; ++i) blob.Value(check[i]);
+    for (int i=0; i<4; ++i)
+        if (check[i] != head[i]) TRACELOG(LOG_FATAL, "Simulator: The state blob doesn't match this simulator!");
+    u8 diverged = (_status & FLAG_DIVERGED) ? 1 : 0;
+    u8 hasprev = _hasprev ? 1 : 0;
+    blob.Value(_t); blob.Value(_ltn);
+    blob.Value(_hstep);
+    blob.Value(_cntstep); blob.Value(_cntreject); blob.Value(_cntjacob);
+    blob.Value(diverged);
+    blob.Bytes(_outvalues.data(), _outvalues.size()*sizeof(double));
+    blob.Bytes(_outref.data(), _outref.size()*sizeof(double));
+    blob.Value(hasprev); blob.Vector(_xprev);
+    blob.Vector(_jacob); blob.Vector(_jacoblu); blob.Vector(_jacobpiv);
+    blob.Value(_jacobgh); blob.Value(_jacobstate);
+    blob.Vector(_hits);
+    blob.Bytes(_due.data(), _due.size());
+    for (std::mt19937 &rng: _lanerng) blob.Engine(rng);
+    for (PUnitModule m: _modules)
+        if (m) Module_State(m, blob);
+    _hasprev = hasprev != 0;
+    if (diverged) _status |= FLAG_DIVERGED;
+    else _status &=~ FLAG_DIVERGED;
+}
+
+void Simulator::SaveState(std::vector<u8> &state) {
+    if (!(_status & FLAG_INITIALIZED))
+        TRACELOG(LOG_FATAL, "Simulator: Only states of initialized simulators can be saved!");
+    state.clear();
+    StateBlob blob{&state, nullptr, nullptr};
+    Transfer_State(blob);
+}
+std::vector<u8> Simulator::SaveState() {
+    std::vector<u8> state;
+    SaveState(state);
+    return state;
+}
+void Simulator::RestoreState(const std::vector<u8> &state) {
+    if (!(_status & FLAG_INITIALIZED))
+        TRACELOG(LOG_FATAL, "Simulator: States can only be restored to initialized simulators!");
+    StateBlob blob{nullptr, state.data(), state.data()+state.size()};
+    Transfer_State(blob);
+    if (blob.in != blob.end)
+        TRACELOG(LOG_FATAL, "Simulator: The state blob doesn't match this simulator!");
+}
+
+NAMESPACE_SIMUCPP_R
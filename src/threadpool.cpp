@@ -0,0 +1,65 @@
+#include "threadpool.hpp"
+#include "definitions.hpp"
+NAMESPACE_SIMUCPP_L
+
+ThreadPool::ThreadPool(uint n) {
+    _size = n<1 ? 1 : n;
+    _f = nullptr;
+    _gen = _remain = 0;
+    _barcnt = _barsense = 0;
+    _quit = false;
+    for (uint i=1; i<_size; ++i)
+        _threads.push_back(std::thread(&ThreadPool::Work, this, i));
+}
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _quit = true;
+        _gen++;
+    }
+    _cv.notify_all();
+    for (std::thread &t: _threads) t.join();
+}
+uint ThreadPool::Get_Size() const { return _size; }
+
+void ThreadPool::Run(const std::function<void(uint)> &f) {
+    if (_size == 1) { f(0); return; }
+    _f = &f;
+    _remain = _size - 1;
+    {
+        std::lock_guard<std::mutex> lock(_mtx);
+        _gen++;
+    }
+    _cv.notify_all();
+    f(0);
+    for (uint spin=0; _remain.load() > 0; ++spin)
+        if (spin >= SIMUCPP_THREAD_SPIN) std::this_thread::yield();
+}
+
+void ThreadPool::Barrier() {
+    uint sense = _barsense.load();
+    if (_barcnt.fetch_add(1) + 1 == _size) {
+        _barcnt = 0;
+        _barsense.fetch_add(1);
+        return;
+    }
+    for (uint spin=0; _barsense.load() == sense; ++spin)
+        if (spin >= SIMUCPP_THREAD_SPIN) std::this_thread::yield();
+}
+
+void ThreadPool::Work(uint id) {
+    uint gen = 0;
+    while (true) {
+        for (uint spin=0; (_gen.load() == gen) && (spin < SIMUCPP_THREAD_SPIN); ++spin);
+        if (_gen.load() == gen) {
+            std::unique_lock<std::mutex> lock(_mtx);
+            _cv.wait(lock, [&]{ return _gen.load() != gen; });
+        }
+        gen = _gen.load();
+        if (_quit) return;
+        (*_f)(id);
+        _remain.fetch_sub(1);
+    }
+}
+
+NAMESPACE_SIMUCPP_R
@@ -0,0 +1,49 @@
+/**********************
+FILE DESCRIPTIONS
+This file contains the class defination of ThreadPool, which is used by
+ Simulator to update the stage schedule on several threads.
+**********************/
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include "baseclass.hpp"
+NAMESPACE_SIMUCPP_L
+
+/**********************
+A fixed amount of workers. Worker 0 is the thread calling "Run()", and the
+ others are background threads which spin for a while after a task before
+ sleeping, because a simulation dispatches a task at every stage.
+**********************/
+class ThreadPool {
+public:
+    // "n" is the amount of workers, including the calling thread.
+    ThreadPool(uint n);
+    ~ThreadPool();
+    // Run "f(worker)" on every workers and return after all of them finished.
+    void Run(const std::function<void(uint)> &f);
+    // Wait until every workers reach this barrier. Only used in "Run()".
+    void Barrier();
+    uint Get_Size() const;
+private:
+    void Work(uint id);
+    uint _size;
+    std::vector<std::thread> _threads;
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    const std::function<void(uint)> *_f;
+    // @_gen: Increased when a task is dispatched.
+    // @_remain: Amount of background workers running the task.
+    std::atomic<uint> _gen, _remain;
+    // @_barcnt: Amount of workers arrived at the barrier.
+    // @_barsense: Increased when every workers arrived at the barrier.
+    std::atomic<uint> _barcnt, _barsense;
+    bool _quit;
+};
+
+NAMESPACE_SIMUCPP_R
+#endif // THREADPOOL_H
@@ -0,0 +1,158 @@
+#include <cstdio>
+#include "trace.hpp"
+#include "simulator.hpp"
+#include "definitions.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define SIMUCPP_MMAP_SUPPORTED
+#endif
+NAMESPACE_SIMUCPP_L
+
+/**********************
+Save the time points and data of OUTPUT modules stored to memory to a trace
+ file. See "trace.hpp" for its layout. Columns are written as they are, so an
+ OUTPUT module whose data is limited by "Set_MaxDataStorage()" has less data.
+**********************/
+int Simulator::Save_Trace(std::string filename) {
+    std::vector<const std::vector<double>*> data(1, &Get_TimeData());
+    std::vector<TraceColumn> columns(1);
+    std::string names = "t";
+    columns[0].sampletime = _T;
+    columns[0].namelen = 1;
+    for (PUOutput m: _outputs) {
+        if (!m->_store || m->_sink) continue;
+        TraceColumn col;
+        col.sampletime = m->_T;
+        col.namelen = m->_name.size();
+        columns.push_back(col);
+        data.push_back(&m->Get_StoredData());
+        names += m->_name;
+    }
+    TraceHead head = {SIMUCPP_TRACE_MAGIC, SIMUCPP_TRACE_VERSION, (uint32_t)columns.size(), 0};
+    uint64_t offset = sizeof(TraceHead) + columns.size()*sizeof(TraceColumn) + names.size();
+    std::vector<char> pad((8 - offset%8) % 8, 0);
+    offset += pad.size();
+    for (uint n=0; n<columns.size(); ++n) {
+        columns[n].length = data[n]->size();
+        columns[n].offset = offset;
+        columns[n].reserved = 0;
+        offset += columns[n].length * sizeof(double);
+    }
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (!f) {
+        TRACELOG(LOG_WARNING, "Simulator: File \"%s\" can't be opened.", filename.c_str());
+        return 1;
+    }
+    bool ok = fwrite(&head, sizeof(head), 1, f) == 1;
+    ok &= fwrite(columns.data(), sizeof(TraceColumn), columns.size(), f) == columns.size();
+    ok &= fwrite(names.data(), 1, names.size(), f) == names.size();
+    ok &= fwrite(pad.data(), 1, pad.size(), f) == pad.size();
+    for (const std::vector<double> *v: data)
+        ok &= fwrite(v->data(), sizeof(double), v->size(), f) == v->size();
+    ok &= fclose(f) == 0;
+    if (!ok) {
+        TRACELOG(LOG_WARNING, "Simulator: Failed to write file \"%s\".", filename.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+
+/**********************
+TRACE reader.
+**********************/
+TraceReader::TraceReader(std::string filename) {
+    _map = nullptr;
+    _size = 0;
+    _columns = nullptr;
+#if defined(SIMUCPP_MMAP_SUPPORTED)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        TRACELOG(LOG_WARNING, "TraceReader: File \"%s\" can't be opened.", filename.c_str());
+        return;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) == 0) && (st.st_size >= (off_t)sizeof(TraceHead))) {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) { _map = (const u8*)p; _size = st.st_size; }
+    }
+    close(fd);
+#else
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        TRACELOG(LOG_WARNING, "TraceReader: File \"%s\" can't be opened.", filename.c_str());
+        return;
+    }
+    long size = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+    if ((size >= (long)sizeof(TraceHead)) && (fseek(f, 0, SEEK_SET) == 0)) {
+        // Doubles keep the data of columns aligned like a mapping does.
+        double *p = new double[(size + sizeof(double) - 1) / sizeof(double)];
+        if (fread(p, 1, size, f) == (size_t)size) { _map = (const u8*)p; _size = size; }
+        else delete[] p;
+    }
+    fclose(f);
+#endif
+    if (!_map) {
+        TRACELOG(LOG_WARNING, "TraceReader: File \"%s\" can't be mapped.", filename.c_str());
+        return;
+    }
+    // Check the header before any column is read.
+    const TraceHead *head = (const TraceHead*)_map;
+    uint64_t pos = sizeof(TraceHead) + (uint64_t)head->columns*sizeof(TraceColumn);
+    bool ok = (head->magic == SIMUCPP_TRACE_MAGIC) && (head->version == SIMUCPP_TRACE_VERSION)
+        && (head->columns >= 1) && (pos <= _size);
+    if (ok) _columns = (const TraceColumn*)(_map + sizeof(TraceHead));
+    for (uint n=0; ok && (n<head->columns); ++n) {
+        const TraceColumn &col = _columns[n];
+        ok = (pos + col.namelen <= _size) && (col.offset%8 == 0) && (col.offset <= _size)
+            && (col.length <= (_size - col.offset)/sizeof(double));
+        if (ok) _names.push_back(std::string((const char*)_map + pos, col.namelen));
+        pos += col.namelen;
+    }
+    if (!ok) {
+        TRACELOG(LOG_WARNING, "TraceReader: File \"%s\" isn't a valid trace file.", filename.c_str());
+        Unmap();
+        _columns = nullptr;
+        _names.clear();
+    }
+}
+TraceReader::~TraceReader() { Unmap(); }
+void TraceReader::Unmap() {
+    if (!_map) return;
+#if defined(SIMUCPP_MMAP_SUPPORTED)
+    munmap((void*)_map, _size);
+#else
+    delete[] (const double*)_map;
+#endif
+    _map = nullptr;
+    _size = 0;
+}
+bool TraceReader::Is_Open() const { return _map != nullptr; }
+uint TraceReader::Get_Count() const { return _names.empty() ? 0 : _names.size()-1; }
+std::string TraceReader::Get_Name(uint n) const { return n<Get_Count() ? _names[n+1] : ""; }
+double TraceReader::Get_SampleTime(uint n) const { return n<Get_Count() ? _columns[n+1].sampletime : 0; }
+TraceView TraceReader::Get_Signal(uint n) const {
+    if (n >= Get_Count()) return TraceView{nullptr, 0};
+    return Get_Column(n+1);
+}
+TraceView TraceReader::Get_Signal(std::string name) const {
+    int n = Find(name);
+    return n<0 ? TraceView{nullptr, 0} : Get_Column(n+1);
+}
+int TraceReader::Find(std::string name) const {
+    for (uint n=1; n<_names.size(); ++n)
+        if (_names[n] == name) return n-1;
+    return -1;
+}
+TraceView TraceReader::Get_Time() const {
+    if (!_map) return TraceView{nullptr, 0};
+    return Get_Column(0);
+}
+TraceView TraceReader::Get_Column(uint n) const {
+    return TraceView{(const double*)(_map + _columns[n].offset), (size_t)_columns[n].length};
+}
+
+NAMESPACE_SIMUCPP_R
@@ -4,14 +4,13 @@
 NAMESPACE_SIMUCPP_L
 
 UnitModule::UnitModule(Simulator *sim, std::string name)
-    : _name(name),_id(-1) {}
+    : _name(name),_outvalue(&_ov),_ov(0),_id(-1) {}
 UnitModule::~UnitModule() {}
 
 /**********************
 CONSTANT module.
 **********************/
 UConstant::~UConstant() {}
-double UConstant::Get_OutValue() const { return _outvalue; }
 void UConstant::Set_Enable(bool enable) { _enable=enable; }
 int UConstant::Self_Check() const { return 0; }
 void UConstant::Module_Update(double time) {}
@@ -19,10 +18,11 @@ void UConstant::Module_Reset() {}
 int UConstant::Get_childCnt() const { return 0; }
 PUnitModule UConstant::Get_child(uint n) const { return nullptr; }
 void UConstant::connect(const PUnitModule m) { TRACELOG(LOG_WARNING, "UConstant: cannot add child modules."); }
-void UConstant::Set_OutValue(double v) { _outvalue=v; };
+void UConstant::Set_OutValue(double v) { *_outvalue=v; };
+void UConstant::Set_Tunable(bool tunable) { _tunable=tunable; }
 UConstant::UConstant(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 1;
+    *_outvalue = 1;
     UNITMODULE_INIT();
 }
 
@@ -31,7 +31,6 @@ UConstant::UConstant(Simulator *sim, std::string name): UnitModule(sim, name)
 FCN module.
 **********************/
 UFcn::~UFcn() { _f=nullptr;_next=nullptr; }
-double UFcn::Get_OutValue() const { return _outvalue; }
 void UFcn::Set_Enable(bool enable) { _enable=enable; }
 void UFcn::Set_Function(std::function<double(double)> function) { _f=function; }
 void UFcn::Module_Reset() {}
@@ -40,7 +39,7 @@ PUnitModule UFcn::Get_child(uint n) const { return n==0?_next:nullptr; }
 void UFcn::connect(const PUnitModule m) { _next=m;_enable=true; }
 UFcn::UFcn(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 0.0/0.0;
+    *_outvalue = 0.0/0.0;
     _f = [](double u){return u;};
     UNITMODULE_INIT();
 }
@@ -53,7 +52,7 @@ int UFcn::Self_Check() const
 void UFcn::Module_Update(double time)
 {
     if (!_enable) return;
-    _outvalue = _f(_next->Get_OutValue());
+    *_outvalue = _f(_next->Get_OutValue());
 }
 
 
@@ -61,14 +60,13 @@ void UFcn::Module_Update(double time)
 FCNMISO module.
 **********************/
 UFcnMISO::~UFcnMISO() { _f=nullptr;_next.clear(); }
-double UFcnMISO::Get_OutValue() const { return _outvalue; }
 void UFcnMISO::Set_Enable(bool enable) { _enable=enable; }
 void UFcnMISO::Set_Function(std::function<double(double*)> function) { _f=function; }
 void UFcnMISO::Module_Reset() {}
 int UFcnMISO::Get_childCnt() const { return _next.size(); }
 UFcnMISO::UFcnMISO(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 0.0/0.0;
+    *_outvalue = 0.0/0.0;
     _f = [](double *u){return u[0];};
     UNITMODULE_INIT();
 }
@@ -89,7 +87,7 @@ void UFcnMISO::Module_Update(double time)
     double* param = new double[n];
     for (int i=0; i<n; ++i)
         param[i] = _next[i]->Get_OutValue();
-    _outvalue = _f(param);
+    *_outvalue = _f(param);
     delete[] param;
 }
 PUnitModule UFcnMISO::Get_child(uint n) const
@@ -120,7 +118,6 @@ void UFcnMISO::disconnect(uint n)
 GAIN module.
 **********************/
 UGain::~UGain() { _next=nullptr; }
-double UGain::Get_OutValue() const { return _outvalue; }
 void UGain::Set_Enable(bool enable) { _enable=enable; }
 void UGain::Set_Gain(double gain) { _gain=gain; }
 void UGain::Module_Reset() {}
@@ -130,7 +127,7 @@ void UGain::connect(const PUnitModule m) { _next=m;_enable=true; }
 UGain::UGain(Simulator *sim, std::string name): UnitModule(sim, name)
 {
     _gain = 1;
-    _outvalue = 0.0/0.0;
+    *_outvalue = 0.0/0.0;
     _next = nullptr;
     UNITMODULE_INIT();
 }
@@ -142,7 +139,7 @@ int UGain::Self_Check() const
 void UGain::Module_Update(double time)
 {
     if (!_enable) return;
-    _outvalue = _gain * _next->Get_OutValue();
+    *_outvalue = _gain * _next->Get_OutValue();
 }
 
 
@@ -150,7 +147,6 @@ void UGain::Module_Update(double time)
 INPUT module.
 **********************/
 UInput::~UInput() { _data.clear();_f=nullptr; }
-double UInput::Get_OutValue() const { return _outvalue; }
 void UInput::Set_Enable(bool enable) { _enable=enable; }
 int UInput::Get_childCnt() const { return 0; }
 PUnitModule UInput::Get_child(uint n) const { return nullptr; }
@@ -161,8 +157,9 @@ void UInput::Set_Continuous(bool isContinuous) { _isc=isContinuous; }
 void UInput::Set_SampleTime(double time) { _T=time; }
 UInput::UInput(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 0.0/0.0;
+    *_outvalue = 0.0/0.0;
     _cnt = -1;
+    _T = -1;
     _isc = true;
     _f = [](double t){return 1.0;};
     UNITMODULE_INIT();
@@ -187,18 +184,18 @@ int UInput::Self_Check() const
 void UInput::Module_Update(double time)
 {
     if (_isc)
-        _outvalue = _f(time);
+        *_outvalue = _f(time);
     else {
-        if (time - _cnt*_T < _T-SIMUCPP_DBL_EPSILON) return;
+        if (!_enable) return;
         _cnt++;
         if (_cnt >= (int)_data.size()) return;
-        _outvalue = _data[_cnt];
+        *_outvalue = _data[_cnt];
     }
 }
 void UInput::Module_Reset()
 {
     _cnt = -1;
-    _outvalue = 0.0/0.0;
+    *_outvalue = 0.0/0.0;
 }
 
 
@@ -206,17 +203,16 @@ void UInput::Module_Reset()
 INTEGRATOR module.
 **********************/
 UIntegrator::~UIntegrator() { _next=nullptr; }
-double UIntegrator::Get_OutValue() const { return _outvalue; }
 void UIntegrator::Set_Enable(bool enable) { _enable=enable; }
-void UIntegrator::Set_InitialValue(double value) { _outvalue=_iv=value; }
+void UIntegrator::Set_InitialValue(double value) { *_outvalue=_iv=value; }
 void UIntegrator::Module_Update(double time) {}
-void UIntegrator::Module_Reset() { _outvalue=_iv; }
+void UIntegrator::Module_Reset() { *_outvalue=_iv; }
 int UIntegrator::Get_childCnt() const { return 1; }
 PUnitModule UIntegrator::Get_child(uint n) const { return n==0?_next:nullptr; }
 void UIntegrator::connect(const PUnitModule m) { _next=m;_enable=true; }
 UIntegrator::UIntegrator(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 0;
+    *_outvalue = 0;
     _iv = 0;
     _next = nullptr;
     UNITMODULE_INIT();
@@ -232,20 +228,21 @@ int UIntegrator::Self_Check() const
 NOISE module.
 **********************/
 UNoise::~UNoise() {}
-double UNoise::Get_OutValue() const { return _outvalue; }
 void UNoise::Set_Enable(bool enable) { _enable=enable; }
 int UNoise::Self_Check() const { return 0; }
-void UNoise::Module_Reset() { _outvalue=0;_ltn=-_T; }
+void UNoise::Module_Reset() { _rng.seed(_seed);*_outvalue=0; }
 int UNoise::Get_childCnt() const { return 0; }
 PUnitModule UNoise::Get_child(uint n) const { return nullptr; }
 void UNoise::connect(const PUnitModule m) { TRACELOG(LOG_WARNING, "UNoise: cannot add child modules."); }
 void UNoise::Set_Mean(double mean) { _mean=mean; }
 void UNoise::Set_Variance(double var) { _var=var; }
-void UNoise::Set_SampleTime(double time) { _T=time;_ltn=-_T; }
+void UNoise::Set_SampleTime(double time) { _T=time; }
+void UNoise::Set_Seed(uint seed) { _seed=seed;_rng.seed(seed); }
 UNoise::UNoise(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    DISCRETE_INITIALIZE(-1);
-    _outvalue = 0.0/0.0;
+    _T = -1;
+    *_outvalue = 0.0/0.0;
+    Set_Seed(0);
     UNITMODULE_INIT();
     _enable = true;
     _mean = 0;
@@ -254,11 +251,10 @@ UNoise::UNoise(Simulator *sim, std::string name): UnitModule(sim, name)
 void UNoise::Module_Update(double time)
 {
     if (!_enable) return;
-    DISCRETE_UPDATE();
-    double U = (rand()+1.0) / (RAND_MAX+1.0);
-    double V = (rand()+1.0) / (RAND_MAX+1.0);
+    double U = (_rng()+1.0) / 4294967296.0;
+    double V = (_rng()+1.0) / 4294967296.0;
     double ans = sqrt(-2.0 * log(U))* cos(6.283185307179586477 * V);
-    _outvalue = _var * ans + _mean;
+    *_outvalue = _var * ans + _mean;
 }
 
 
@@ -266,24 +262,34 @@ void UNoise::Module_Update(double time)
 OUTPUT module.
 **********************/
 UOutput::~UOutput() { _values.clear(); }
-double UOutput::Get_OutValue() const { return _outvalue; }
 void UOutput::Set_Enable(bool enable) { _enable=enable; }
-void UOutput::Module_Reset() { _values.clear();_outvalue=0;_ltn=-_T; }
+void UOutput::Module_Reset() { _values.clear();_packed.Clear();_ring.Clear();*_outvalue=0; if (_sink) _sink->Reset(); }
 int UOutput::Get_childCnt() const { return 1; }
 PUnitModule UOutput::Get_child(uint n) const { return n==0?_next:nullptr; }
 void UOutput::connect(const PUnitModule m) { _next=m;_enable=true; }
-vecdble& UOutput::Get_StoredData() { return _values; }
-void UOutput::Set_SampleTime(double time) { _T=time;_ltn=-_T; }
+vecdble& UOutput::Get_StoredData() {
+    if (_compress) _packed.Decode(_values);
+    else if (_maxstorage > 0) _ring.Copy(_values);
+    return _values; }
+const CompressedSeries& UOutput::Get_CompressedData() { return _packed; }
+void UOutput::Set_SampleTime(double time) { _T=time; }
 void UOutput::Set_EnableStore(bool store) { _store=store; }
 void UOutput::Set_InputGain(double inputgain) { _ingain=inputgain; }
-void UOutput::Set_MaxDataStorage(int n) { _maxstorage=n; }
+void UOutput::Set_MaxDataStorage(int n) {
+    _maxstorage=n; _ring.Set_Capacity(n>0 && !_compress ? n : 0); }
+const RingBuffer& UOutput::Get_RingData() { return _ring; }
+void UOutput::Set_Sink(PSink sink) { _sink=sink; }
+void UOutput::Set_EnableCompress(bool compress) {
+    _compress=compress; _ring.Set_Capacity(_maxstorage>0 && !_compress ? _maxstorage : 0); }
 UOutput::UOutput(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    DISCRETE_INITIALIZE(-1);
-    _outvalue = 0;
+    _T = -1;
+    *_outvalue = 0;
     _ingain = 1;
     _maxstorage = -1;
     _store = true;
+    _compress = false;
+    _packed = CompressedSeries(true);
     _next = nullptr;
     UNITMODULE_INIT();
 }
@@ -295,12 +301,16 @@ int UOutput::Self_Check() const
 void UOutput::Module_Update(double time)
 {
     if (!_enable) return;
-    DISCRETE_UPDATE();
-    _outvalue = _ingain * _next->Get_OutValue();
+    *_outvalue = _ingain * _next->Get_OutValue();
     if (!_store) return;
-    _values.push_back(_outvalue);
-    if (_maxstorage>0 && (int)_values.size()>_maxstorage)
-        _values.erase(_values.begin());
+    if (_sink) { _sink->Write(time, *_outvalue); return; }
+    if (_compress) {
+        _packed.Push(*_outvalue);
+        if (_maxstorage>0 && (int)_packed.Size()>_maxstorage) _packed.Drop_Front(1);
+        return;
+    }
+    if (_maxstorage>0) _ring.Push(*_outvalue);
+    else _values.push_back(*_outvalue);
 }
 
 
@@ -308,13 +318,12 @@ void UOutput::Module_Update(double time)
 PRODUCT module.
 **********************/
 UProduct::~UProduct() { _next.clear();_ingain.clear(); }
-double UProduct::Get_OutValue() const { return _outvalue; }
 void UProduct::Set_Enable(bool enable) { _enable=enable; }
 void UProduct::Module_Reset() {}
 int UProduct::Get_childCnt() const { return _next.size(); }
 UProduct::UProduct(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 0.0/0.0;
+    *_outvalue = 0.0/0.0;
     UNITMODULE_INIT();
 }
 void UProduct::Set_InputGain(double inputgain, int port)
@@ -345,7 +354,7 @@ void UProduct::Module_Update(double time)
     double ans = 1;
     for (int i=_next.size()-1; i>=0; --i)
         ans *= _ingain[i] * _next[i]->Get_OutValue();
-    _outvalue = ans;
+    *_outvalue = ans;
 }
 PUnitModule UProduct::Get_child(uint n) const
 {
@@ -376,14 +385,13 @@ void UProduct::disconnect(uint n)
 SUM module.
 **********************/
 USum::~USum() { _next.clear();_ingain.clear(); }
-double USum::Get_OutValue() const { return _outvalue; }
 void USum::Set_Enable(bool enable) { _enable=enable; }
 void USum::Module_Reset() {}
 int USum::Get_childCnt() const { return _next.size(); }
 void USum::Set_Redundant(bool rdnt) { _rdnt=rdnt; };
 USum::USum(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 0.0/0.0;
+    *_outvalue = 0.0/0.0;
     _rdnt = true;
     UNITMODULE_INIT();
 }
@@ -416,7 +424,7 @@ void USum::Module_Update(double time)
     double ans = 0;
     for (int i=_next.size()-1; i>=0; --i)
         ans += _ingain[i] * _next[i]->Get_OutValue();
-    _outvalue = ans;
+    *_outvalue = ans;
 }
 PUnitModule USum::Get_child(uint n) const
 {
@@ -447,58 +455,96 @@ void USum::disconnect(uint n)
 /**********************
 TRANSPORTDELAY module.
 **********************/
-UTransportDelay::~UTransportDelay() { _next=nullptr; }
-double UTransportDelay::Get_OutValue() const { return _outvalue; }
+UTransportDelay::~UTransportDelay() { _next=_delayin=nullptr; }
 void UTransportDelay::Set_Enable(bool enable) { _enable=enable; }
-void UTransportDelay::Set_InitialValue(double value) { _outvalue=_iv=value; }
-int UTransportDelay::Get_childCnt() const { return 1; }
-PUnitModule UTransportDelay::Get_child(uint n) const { return n==0?_next:nullptr; }
+void UTransportDelay::Set_InitialValue(double value) { *_outvalue=_iv=value; }
+void UTransportDelay::Set_MaxDelayTime(double time) { _maxdelay=time; }
+void UTransportDelay::Set_Interpolation(int interp) { _interp=interp; }
+int UTransportDelay::Get_childCnt() const { return _delayin ? 2 : 1; }
+PUnitModule UTransportDelay::Get_child(uint n) const { return n==0 ? _next : (n==1 ? _delayin : nullptr); }
 void UTransportDelay::connect(const PUnitModule m) { _next=m;_enable=true; }
+void UTransportDelay::Set_DelayInput(PUnitModule m) {
+    if (m && (m->_sim != _sim))
+        TRACELOG(LOG_FATAL, "TRANSPORTDELAY: Module \"%s\" is added to a wrong simulator!", m->_name.c_str());
+    _delayin = m;
+}
 UTransportDelay::UTransportDelay(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    _outvalue = 0.0/0.0;
-    _iv = 0;
-    _lv.push_back(0);
-    _next = nullptr;
+    *_outvalue = _iv = 0;
+    _next = _delayin = nullptr;
+    _interp = INTERP_LINEAR;
+    _delay = _maxdelay = -1;
+    _nexttime = _simstep = 0;
     UNITMODULE_INIT();
-    _nexttime = _simstep = sim->Get_SimStep();
 }
 void UTransportDelay::Set_DelayTime(double time)
 {
-    int delayPoints = time/_simstep + 0.5;
-    if (delayPoints<=0) TRACELOG(LOG_WARNING, "TRANSPORTDELAY module was given an improper delay time.");        
-    if (delayPoints>0){
-        _lv = vecdble(delayPoints);
-        for (int i=_lv.size()-1; i>=0; --i)
-            _lv[i] = _iv;
-    }
-    else {
-        _lv = vecdble{};
-    }
+    if (time<0) TRACELOG(LOG_WARNING, "TRANSPORTDELAY module was given an improper delay time.");
+    _delay = _maxdelay = time>0 ? time : 0;
+}
+void UTransportDelay::Initialize(double step)
+{
+    _nexttime = _simstep = step;
+    if (_delay < 0) _delay = step;
+    if (_maxdelay < 0) _maxdelay = _delay;
+    double maxdelay = _delayin ? SIMUCPP_MAX(_maxdelay, _delay) : _delay;
+    // Two more values for interpolation and one for the latest value.
+    _lv.Set_Capacity(ceil(maxdelay/step) + 3);
+    _lv.Clear();
 }
 int UTransportDelay::Self_Check() const
 {
     CHECK_CHILD(TRANSPORTDELAY);
     return 0;
 }
+double UTransportDelay::Stored_Value(int k) const
+{
+    // Values before the first stored one are the initial value.
+    return k < (int)_lv.Size() ? _lv[_lv.Size()-1-k] : _iv;
+}
+/**********************
+The latest input value is stored once every simulation step, and the output
+ is the input value "delay/step" steps ago. Delays of whole steps aren't
+ interpolated, so that they give the same stored values in every modes.
+A variable-step solver may pass several steps at once, and input values of
+ the steps passed before the latest one are interpolated between the last
+ stored value and the latest input value.
+**********************/
 void UTransportDelay::Module_Update(double time)
 {
     if (!_enable) return;
-    if (time < _nexttime) return;
+    // The tolerance absorbs rounding errors between accumulated time points.
+    if (time < _nexttime - SIMUCPP_DBL_EPSILON*_simstep) return;
+    double u = _next->Get_OutValue();
+    double t0 = _nexttime - _simstep, u0 = Stored_Value(0);
+    for (; time >= _nexttime + (1-SIMUCPP_DBL_EPSILON)*_simstep; _nexttime += _simstep)
+        _lv.Push(u0 + (u-u0)*(_nexttime-t0)/(time-t0));
     _nexttime += _simstep;
-    if (_lv.size()>0){
-        _outvalue = _lv[0];
-        _lv.erase(_lv.begin());
-        _lv.push_back(_next->Get_OutValue());
+    _lv.Push(u);
+    double delay = _delayin ? SIMUCPP_LIMIT(_delayin->Get_OutValue(), 0, _maxdelay) : _delay;
+    double lag = delay / _simstep;
+    double k = floor(lag + 0.5);
+    if ((_interp == INTERP_NEAREST) || (fabs(lag - k) < 1e-9)) {
+        *_outvalue = Stored_Value(k);
+        return;
     }
-    else{
-        _outvalue = _next->Get_OutValue();
+    int k0 = floor(lag);
+    double f = lag - k0;
+    if (_interp == INTERP_LINEAR) {
+        *_outvalue = (1-f)*Stored_Value(k0) + f*Stored_Value(k0+1);
+        return;
     }
+    // Four values around the lag, and "x" is the lag from the first one.
+    int b = k0>0 ? k0-1 : 0;
+    double x = lag - b;
+    *_outvalue = -Stored_Value(b)*(x-1)*(x-2)*(x-3)/6 + Stored_Value(b+1)*x*(x-2)*(x-3)/2
+                 -Stored_Value(b+2)*x*(x-1)*(x-3)/2 + Stored_Value(b+3)*x*(x-1)*(x-2)/6;
 }
 void UTransportDelay::Module_Reset()
 {
-    for (int i=_lv.size()-1; i>=0; --i)
-        _lv[i] = _iv;
+    _lv.Clear();
+    _nexttime = _simstep;
+    *_outvalue = _iv;
 }
 
 
@@ -506,18 +552,17 @@ void UTransportDelay::Module_Reset()
 UNITDELAY module.
 **********************/
 UUnitDelay::~UUnitDelay() { _next=nullptr; }
-double UUnitDelay::Get_OutValue() const { return _outvalue; }
 void UUnitDelay::Set_Enable(bool enable) { _enable=enable; }
-void UUnitDelay::Set_InitialValue(double value) { _outvalue=_lv=_iv=value; }
-void UUnitDelay::Module_Reset() { _outvalue=_lv=_iv; }
+void UUnitDelay::Set_InitialValue(double value) { *_outvalue=_lv=_iv=value; }
+void UUnitDelay::Module_Reset() { *_outvalue=_lv=_iv; }
 int UUnitDelay::Get_childCnt() const { return 1; }
 PUnitModule UUnitDelay::Get_child(uint n) const { return n==0?_next:nullptr; }
 void UUnitDelay::connect(const PUnitModule m) { _next=m;_enable=true; }
-void UUnitDelay::Set_SampleTime(double time) { _T=time;_ltn=-_T; }
+void UUnitDelay::Set_SampleTime(double time) { _T=time; }
 UUnitDelay::UUnitDelay(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    DISCRETE_INITIALIZE(1);
-    _iv = _lv = _outvalue = 0;
+    _T = 1;
+    _iv = _lv = *_outvalue = 0;
     _next = nullptr;
     UNITMODULE_INIT();
 }
@@ -529,13 +574,11 @@ int UUnitDelay::Self_Check() const
 void UUnitDelay::Module_Update(double time)
 {
     if (!_enable) return;
-    DISCRETE_UPDATE();
     _lv = _next->Get_OutValue();
 }
-void UUnitDelay::Output_Update(double time)
+void UUnitDelay::Output_Update()
 {
-    if (time - _ltn < _T-SIMUCPP_DBL_EPSILON) return;
-    _outvalue = _lv;
+    *_outvalue = _lv;
 }
 
 
@@ -543,17 +586,16 @@ void UUnitDelay::Output_Update(double time)
 ZOH module.
 **********************/
 UZOH::~UZOH() { _next=nullptr; }
-double UZOH::Get_OutValue() const { return _outvalue; }
 void UZOH::Set_Enable(bool enable) { _enable=enable; }
-void UZOH::Module_Reset() { _outvalue=0;_ltn=-_T; }
+void UZOH::Module_Reset() { *_outvalue=0; }
 int UZOH::Get_childCnt() const { return 1; }
 PUnitModule UZOH::Get_child(uint n) const { return n==0?_next:nullptr; }
 void UZOH::connect(const PUnitModule m) { _next=m;_enable=true; }
-void UZOH::Set_SampleTime(double time) { _T=time;_ltn=-_T; }
+void UZOH::Set_SampleTime(double time) { _T=time; }
 UZOH::UZOH(Simulator *sim, std::string name): UnitModule(sim, name)
 {
-    DISCRETE_INITIALIZE(1);
-    _outvalue = 0.0/0.0;
+    _T = 1;
+    *_outvalue = 0.0/0.0;
     _next = nullptr;
     UNITMODULE_INIT();
 }
@@ -565,8 +607,7 @@ int UZOH::Self_Check() const
 void UZOH::Module_Update(double time)
 {
     if (!_enable) return;
-    DISCRETE_UPDATE();
-    _outvalue = _next->Get_OutValue();
+    *_outvalue = _next->Get_OutValue();
 }
 
 NAMESPACE_SIMUCPP_R
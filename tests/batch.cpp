@@ -0,0 +1,60 @@
+/**********************
+Tests of the batch runner, whose results don't depend on the amount of
+ threads or on which worker runs a run.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x'=-g*x+n, and the gain of every run is 1+0.1*run, which is set by
+//  parameter handle 0 of every simulator.
+PSimulator Build(UOutput **out=nullptr) {
+    PSimulator sim = new Simulator(1);
+    FUIntegrator(x, sim); FUGain(g, sim); FUNoise(n, sim); FUSum(s, sim); FUOutput(o, sim);
+    x->Set_InitialValue(1);
+    n->Set_SampleTime(0.01);
+    sim->connectU(x, g); sim->connectU(g, s); s->Set_InputGain(-1);
+    sim->connectU(n, s); sim->connectU(s, x); sim->connectU(x, o);
+    sim->Initialize();
+    CHECK(sim->Get_Parameter(g, "gain") == 0);
+    if (out) *out = o;
+    return sim;
+}
+
+void Run(BatchRunner &runner, UOutput *o, uint runs) {
+    runner.Set_Seed(7);
+    runner.Set_Setup([](PSimulator sim, uint run){ sim->Set_Parameter(0, 1 + 0.1*run); });
+    CHECK(runner.Add_Output(o) == 0);
+    runner.Run(runs);
+    for (uint r=0; r<runs; ++r) CHECK(runner.Get_Status(r) == 0);
+}
+
+int main() {
+    const uint runs = 24;
+    UOutput *o;
+    PSimulator proto = Build(&o);
+    BatchRunner one(proto, 1), four(proto, 4);
+    Run(one, o, runs);
+    Run(four, o, runs);
+    uint bad = 0;
+    for (uint r=0; r<runs; ++r) {
+        if (one.Get_Data(r, 0) != four.Get_Data(r, 0)) bad++;
+        if (one.Get_Data(r, 0).size() != 1001) bad++;
+    }
+    CHECK(bad == 0);
+    // Runs have different gains and noises.
+    CHECK(one.Get_Data(0, 0) != one.Get_Data(1, 0));
+    double mean = 0;
+    for (uint r=0; r<runs; ++r) mean += one.Get_Data(r, 0).back() / runs;
+    CHECK(mean < exp(-1.0));
+
+    // Simulators built by a factory give the same results as clones.
+    BatchRunner built([](){ return Build(); }, 3);
+    Run(built, o, runs);
+    bad = 0;
+    for (uint r=0; r<runs; ++r)
+        if (built.Get_Data(r, 0) != one.Get_Data(r, 0)) bad++;
+    CHECK(bad == 0);
+    delete proto;
+    return failed;
+}
@@ -0,0 +1,49 @@
+/**********************
+Tests of the implicit BDF2 solver against known solutions.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x'=-x, x(0)=1, and x(t)=exp(-t).
+double Decay(double step) {
+    Simulator sim(2);
+    FUIntegrator(x, &sim); FUGain(g, &sim); FUOutput(o, &sim);
+    x->Set_InitialValue(1);
+    sim.connectU(x, g); g->Set_Gain(-1); sim.connectU(g, x);
+    sim.connectU(x, o);
+    sim.Set_SimStep(step);
+    sim.Set_Solver(SOLVER_BDF2);
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(sim.Get_t(), 2, 1e-9);
+    return x->Get_OutValue();
+}
+
+// x'=-1000*(x-cos(t)), x(0)=0, which is stiff, and after the transient
+//  x(t)=(1e6*cos(t)+1e3*sin(t))/(1e6+1).
+// Explicit solvers diverge at this step, and the Jacobian is reused.
+void Stiff() {
+    Simulator sim(2);
+    FUIntegrator(x, &sim); FUInput(in, &sim); FUSum(s, &sim); FUOutput(o, &sim);
+    in->Set_Function([](double t){ return cos(t); });
+    sim.connectU(in, s); s->Set_InputGain(1000);
+    sim.connectU(x, s); s->Set_InputGain(-1000);
+    sim.connectU(s, x); sim.connectU(x, o);
+    sim.Set_SimStep(0.01);
+    sim.Set_Solver(SOLVER_BDF2);
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(x->Get_OutValue(), (1e6*cos(2.0) + 1e3*sin(2.0))/(1e6+1), 1e-4);
+    CHECK(sim.Get_JacobianCount() < 10);
+}
+
+int main() {
+    // BDF2 is of order 2, so halving the step quarters the error.
+    double e1 = fabs(Decay(0.01) - exp(-2.0));
+    double e2 = fabs(Decay(0.005) - exp(-2.0));
+    CHECK(e1 < 1e-4);
+    CHECK_NEAR(e1/e2, 4, 0.5);
+    Stiff();
+    return failed;
+}
@@ -0,0 +1,24 @@
+/**********************
+Checks shared by test programs. A test program returns the amount of failed
+ checks, so ctest reports it if any check fails.
+**********************/
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+#include <cmath>
+#include <cstdio>
+
+static int failed = 0;
+
+#define CHECK(x) do { \
+    if (!(x)) { printf("%s:%d: CHECK(%s) failed.\n", __FILE__, __LINE__, #x); failed++; } \
+} while (0)
+#define CHECK_NEAR(a, b, tol) do { \
+    double _a = (a), _b = (b); \
+    if (!(fabs(_a - _b) <= (tol))) { \
+        printf("%s:%d: CHECK_NEAR(%s, %s) failed: %.17g and %.17g differ by more than %g.\n", \
+            __FILE__, __LINE__, #a, #b, _a, _b, (double)(tol)); \
+        failed++; \
+    } \
+} while (0)
+
+#endif // TESTS_CHECK_H
@@ -0,0 +1,66 @@
+/**********************
+Tests of cloned simulators, which continue exactly like the simulator they
+ are cloned from and don't depend on it.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x'=-x-0.5*d+n+y, where d is a unit delay of x, n is noise, and y=u-0.5*y
+//  is an algebraic loop of a transport delay "u" of x.
+struct Model {
+    Simulator sim;
+    UIntegrator *x;
+    UOutput *o;
+    Model(): sim(2) {
+        FUNoise(n, &sim); FUUnitDelay(d, &sim); FUTransportDelay(td, &sim);
+        FUSum(s, &sim); FUSum(y, &sim); FUGain(g, &sim);
+        x = new UIntegrator(&sim); o = new UOutput(&sim);
+        x->Set_InitialValue(1);
+        n->Set_SampleTime(0.05); n->Set_Variance(0.1);
+        d->Set_SampleTime(0.1);
+        td->Set_DelayTime(0.2);
+        sim.connectU(x, d); sim.connectU(x, td);
+        sim.connectU(td, y); sim.connectU(g, y); y->Set_InputGain(-1);
+        sim.connectU(y, g); g->Set_Gain(0.5);
+        sim.connectU(x, s); s->Set_InputGain(-1);
+        sim.connectU(d, s); s->Set_InputGain(-0.5);
+        sim.connectU(n, s); sim.connectU(y, s);
+        sim.connectU(s, x); sim.connectU(x, o);
+        sim.Initialize();
+    }
+};
+
+int main() {
+    Model m;
+    while (m.sim.Get_t() < 0.5) m.sim.Simulate_OneStep();
+    Simulator *copy = m.sim.Clone();
+    CHECK(copy != nullptr);
+    if (!copy) return failed;
+    UIntegrator *x = copy->Get_Module(m.x);
+    UOutput *o = copy->Get_Module(m.o);
+    CHECK(x != m.x);
+    CHECK(x->Get_OutValue() == m.x->Get_OutValue());
+
+    // A clone of the clone, and the clone keeps working after the original is reset.
+    Simulator *copy2 = copy->Clone();
+    CHECK(copy2 != nullptr);
+    if (!copy2) return failed;
+    CHECK(m.sim.Simulate() == 0);
+    std::vector<double> data = m.o->Get_StoredData();
+    m.sim.Simulation_Reset();
+    CHECK(copy->Simulate() == 0);
+    CHECK(copy2->Simulate() == 0);
+    CHECK(copy->Get_t() == copy2->Get_t());
+    CHECK(x->Get_OutValue() == data.back());
+    CHECK(copy2->Get_Module(m.x)->Get_OutValue() == data.back());
+    CHECK(o->Get_StoredData() == data);
+
+    // A reset clone reproduces the whole simulation.
+    copy->Simulation_Reset();
+    CHECK(copy->Simulate() == 0);
+    CHECK(o->Get_StoredData() == data);
+    delete copy2;
+    delete copy;
+    return failed;
+}
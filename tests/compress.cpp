@@ -0,0 +1,73 @@
+/**********************
+Tests of the XOR codec of compressed series, which decodes values bit for bit.
+**********************/
+#include <cstring>
+#include <limits>
+#include <random>
+#include "compress.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+bool Same(double a, double b) { return memcmp(&a, &b, sizeof(double)) == 0; }
+
+void RoundTrip(bool delta, uint blocksize) {
+    std::vector<double> values = { 0.0, -0.0, 1.0, 1.0, -1.0,
+        std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::denorm_min(),
+        std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest() };
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise;
+    for (int i=0; i<3000; ++i) values.push_back(sin(i*0.01));
+    for (int i=0; i<1000; ++i) values.push_back(noise(gen));
+    for (int i=0; i<1000; ++i) values.push_back(0.125*i);
+    CompressedSeries s(delta, blocksize);
+    for (double v: values) s.Push(v);
+    CHECK(s.Size() == values.size());
+
+    std::vector<double> out;
+    s.Decode(out);
+    CHECK(out.size() == values.size());
+    uint bad = 0;
+    for (size_t i=0; i<out.size() && i<values.size(); ++i)
+        if (!Same(out[i], values[i])) bad++;
+    CHECK(bad == 0);
+
+    // Drop values across a block boundary, then read by index backwards and
+    //  by the iterator.
+    size_t drop = blocksize + 7;
+    s.Drop_Front(drop);
+    CHECK(s.Size() == values.size()-drop);
+    bad = 0;
+    for (size_t i=s.Size(); i>0; --i)
+        if (!Same(s.At(i-1), values[drop+i-1])) bad++;
+    CHECK(bad == 0);
+    bad = 0;
+    size_t i = drop;
+    for (double v: s) if (!Same(v, values[i++])) bad++;
+    CHECK(bad == 0);
+    CHECK(i == values.size());
+
+    // Values pushed after dropping are appended.
+    s.Push(2.5);
+    CHECK(s.At(s.Size()-1) == 2.5);
+    s.Clear();
+    CHECK(s.Size() == 0);
+    s.Push(3);
+    CHECK(s.At(0) == 3);
+}
+
+// Values of a constant slope are stored in much less than 8 bytes each.
+void Ratio() {
+    CompressedSeries s(true);
+    for (int i=0; i<10000; ++i) s.Push(0.125*i);
+    CHECK(s.Get_Bytes() < 10000);
+}
+
+int main() {
+    RoundTrip(false, 1024);
+    RoundTrip(true, 1024);
+    RoundTrip(false, 64);
+    RoundTrip(true, 1);
+    Ratio();
+    return failed;
+}
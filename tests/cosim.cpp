@@ -0,0 +1,49 @@
+/**********************
+Tests of co-simulation, in which a master exchanges port values with the
+ simulator and advances it by communication steps.
+**********************/
+#include <cmath>
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// The plant x'=u-x with y=2*x is controlled by u=1-y held in every
+//  communication step "h", so x(t+h)=u+(x(t)-u)*exp(-h) exactly.
+void Plant(int solver) {
+    Simulator sim(10);
+    FUConstant(u, &sim); FUIntegrator(x, &sim); FUSum(s, &sim); FUGain(y, &sim);
+    x->Set_InitialValue(1);
+    sim.connectU(u, s); sim.connectU(x, s); s->Set_InputGain(-1);
+    sim.connectU(s, x); sim.connectU(x, y); y->Set_Gain(2);
+    FUOutput(o, &sim); sim.connectU(y, o);
+    sim.Set_Solver(solver);
+    sim.Set_CoPorts({u}, {y});
+    sim.Initialize();
+    const double h = 0.1;
+    double *in = sim.Get_CoInputs();
+    const double *out = sim.Get_CoOutputs();
+    double xt = 1, uk, yk;
+    for (int k=0; k<20; ++k) {
+        uk = 1 - 2*xt;
+        sim.Set_CoInputs(&uk);
+        CHECK(in[0] == uk);
+        CHECK(u->Get_OutValue() == uk);
+        CHECK(sim.DoStep(h) == 0);
+        xt = uk + (xt-uk)*exp(-h);
+        CHECK_NEAR(sim.Get_t(), (k+1)*h, 1e-9);
+        sim.Get_CoOutputs(&yk);
+        CHECK(yk == out[0]);
+        CHECK(yk == y->Get_OutValue());
+        CHECK_NEAR(yk, 2*xt, 1e-8);
+    }
+    // Inputs written in place are used by the next step.
+    in[0] = 0;
+    CHECK(sim.DoStep(h) == 0);
+    CHECK_NEAR(out[0], 2*xt*exp(-h), 1e-8);
+}
+
+int main() {
+    Plant(SOLVER_RK4);
+    Plant(SOLVER_RK45);
+    return failed;
+}
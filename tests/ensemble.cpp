@@ -0,0 +1,62 @@
+/**********************
+Tests of ensemble mode, whose lane 0 is the model itself and other lanes are
+ its variants.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x'=g*x+n1+n2, and both noises are stored.
+struct Model {
+    Simulator sim;
+    UIntegrator *x;
+    UGain *g;
+    UOutput *ox, *o1, *o2;
+    Model(uint lanes): sim(1) {
+        FUNoise(n1, &sim); FUNoise(n2, &sim); FUSum(s, &sim);
+        x = new UIntegrator(&sim); g = new UGain(&sim);
+        ox = new UOutput(&sim); o1 = new UOutput(&sim); o2 = new UOutput(&sim);
+        n2->Set_SampleTime(0.01);
+        x->Set_InitialValue(1); g->Set_Gain(-1);
+        sim.connectU(x, g); sim.connectU(g, s); sim.connectU(n1, s); sim.connectU(n2, s);
+        sim.connectU(s, x);
+        sim.connectU(x, ox); sim.connectU(n1, o1); sim.connectU(n2, o2);
+        sim.Set_Ensemble(lanes);
+        sim.Initialize();
+    }
+};
+
+bool Same(const std::vector<double> &a, const std::vector<double> &b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i=0; i<a.size(); ++i) if (a[i] != b[i]) return false;
+    return true;
+}
+
+int main() {
+    Model one(1), four(4);
+    four.sim.Set_LaneGain(four.g, 1, -2);
+    CHECK(one.sim.Simulate() == 0);
+    CHECK(four.sim.Simulate() == 0);
+
+    // Lane 0 is the model itself bit for bit, also with noises.
+    CHECK(Same(four.sim.Get_LaneData(four.ox, 0), one.ox->Get_StoredData()));
+    CHECK(Same(four.sim.Get_LaneData(four.o1, 0), one.o1->Get_StoredData()));
+    CHECK(Same(four.sim.Get_LaneData(four.o2, 0), one.o2->Get_StoredData()));
+    CHECK(four.x->Get_OutValue() == one.x->Get_OutValue());
+
+    // Every noise has its own numbers in every lane.
+    for (uint l=1; l<4; ++l) {
+        CHECK(!Same(four.sim.Get_LaneData(four.o1, l), four.sim.Get_LaneData(four.o1, 0)));
+        CHECK(!Same(four.sim.Get_LaneData(four.o1, l), four.sim.Get_LaneData(four.o2, l)));
+        CHECK(!Same(four.sim.Get_LaneData(four.ox, l), four.sim.Get_LaneData(four.ox, 0)));
+    }
+    CHECK(!Same(four.sim.Get_LaneData(four.o1, 1), four.sim.Get_LaneData(four.o1, 2)));
+    CHECK(four.sim.Get_LaneData(four.o2, 1).size() == one.o2->Get_StoredData().size());
+
+    // A reset simulation reproduces every lane.
+    std::vector<double> lane2 = four.sim.Get_LaneData(four.ox, 2);
+    four.sim.Simulation_Reset();
+    CHECK(four.sim.Simulate() == 0);
+    CHECK(Same(four.sim.Get_LaneData(four.ox, 2), lane2));
+    return failed;
+}
@@ -0,0 +1,59 @@
+/**********************
+Tests of the compiled model, whose results are identical to those of the
+ instruction tape, which it is generated from.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// Damped oscillators x1'=x2, x2'=u*z-0.5*x2-x1-0.1*x1^3-0.01*y, where y is the
+//  sum of all x1, u is a step and z holds x1 of the first oscillator every 0.1 s.
+std::vector<double> Run(bool jit, bool *compiled=nullptr, int n=8) {
+    Simulator sim(2);
+    FUInput(in, &sim); FUSum(total, &sim); FUZOH(zoh, &sim); FUOutput(out, &sim);
+    in->Set_Function([](double t){ return t<1 ? 1.0 : 0.0; });
+    zoh->Set_SampleTime(0.1);
+    std::vector<UIntegrator*> xs;
+    for (int i=0; i<n; ++i) {
+        FUIntegrator(x1, &sim); FUIntegrator(x2, &sim); FUSum(sum, &sim);
+        FUFcn(cube, &sim); FUGain(damp, &sim); FUProduct(force, &sim);
+        x1->Set_InitialValue(0.01*i);
+        cube->Set_Function([](double u){ return u*u*u; });
+        damp->Set_Gain(0.5);
+        sim.connectU(in, force); sim.connectU(zoh, force);
+        sim.connectU(x1, cube); sim.connectU(x2, damp);
+        sim.connectU(force, sum);
+        sim.connectU(damp, sum); sum->Set_InputGain(-1);
+        sim.connectU(x1, sum); sum->Set_InputGain(-1);
+        sim.connectU(cube, sum); sum->Set_InputGain(-0.1);
+        sim.connectU(total, sum); sum->Set_InputGain(-0.01);
+        sim.connectU(sum, x2); sim.connectU(x2, x1);
+        sim.connectU(x1, total);
+        if (i == 0) sim.connectU(x1, zoh);
+        xs.push_back(x1);
+    }
+    sim.connectU(total, out);
+    if (jit) sim.Set_EnableJIT(true, "jit");
+    sim.Initialize();
+    if (compiled) *compiled = sim.Get_EnableJIT();
+    CHECK(sim.Simulate() == 0);
+    std::vector<double> x;
+    for (UIntegrator *m: xs) x.push_back(m->Get_OutValue());
+    for (double y: out->Get_StoredData()) x.push_back(y);
+    return x;
+}
+
+int main() {
+    bool compiled = false;
+    std::vector<double> tape = Run(false);
+    std::vector<double> jit = Run(true, &compiled);
+    if (!compiled) {
+        printf("JIT isn't supported here, so only the tape is tested.\n");
+        CHECK(jit == tape);
+        return failed;
+    }
+    CHECK(jit == tape);
+    // A cached library gives the same results again.
+    CHECK(Run(true) == tape);
+    return failed;
+}
@@ -0,0 +1,54 @@
+/**********************
+Tests of linear blocks, which give the results of the instruction tape up to
+ rounding.
+**********************/
+#include <cmath>
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// Largest difference between "a" and "b" relative to the largest value of "b".
+double Difference(const std::vector<double> &a, const std::vector<double> &b) {
+    double diff = 0, scale = 0;
+    for (uint i=0; i<b.size(); ++i) {
+        diff = std::max(diff, std::fabs(a[i]-b[i]));
+        scale = std::max(scale, std::fabs(b[i]));
+    }
+    return diff / scale;
+}
+
+// Two transfer functions in series, whose output is fed back through a
+//  saturation, driven by a step and by a sum of gains, so every kind of
+//  linear module and both boundaries of a linear block are used.
+std::vector<double> Run(bool linear, uint *merged=nullptr) {
+    Simulator sim(10);
+    FUInput(in, &sim); FUGain(k, &sim); FUSum(err, &sim);
+    FUFcn(sat, &sim); FUGain(fb, &sim); FUOutput(o1, &sim); FUOutput(o2, &sim);
+    TransferFcn *tf1 = new TransferFcn(&sim, {1, 2}, {1, 0.4, 1}, "tf1");
+    TransferFcn *tf2 = new TransferFcn(&sim, {3}, {1, 1.5, 0.8, 0.3}, "tf2");
+    in->Set_Function([](double t){ return t<5 ? 1.0 : -0.5; });
+    sat->Set_Function([](double u){ return u>1 ? 1.0 : (u<-1 ? -1.0 : u); });
+    k->Set_Gain(2); fb->Set_Gain(0.7);
+    sim.connectU(in, k); sim.connectU(k, err);
+    sim.connectU(fb, err); err->Set_InputGain(-1);
+    sim.connectU(err, tf1, 0); sim.connectU(tf1, 0, tf2, 0);
+    sim.connectU(tf2, 0, sat); sim.connectU(sat, fb);
+    sim.connectU(tf1, 0, o1); sim.connectU(tf2, 0, o2);
+    if (linear) sim.Set_EnableLinear();
+    sim.Initialize();
+    if (merged) *merged = sim.Get_LinearCount();
+    CHECK(sim.Simulate() == 0);
+    std::vector<double> y = o1->Get_StoredData();
+    for (double v: o2->Get_StoredData()) y.push_back(v);
+    return y;
+}
+
+int main() {
+    uint merged = 0;
+    std::vector<double> tape = Run(false);
+    std::vector<double> linear = Run(true, &merged);
+    CHECK(merged > 0);
+    CHECK(linear.size() == tape.size());
+    CHECK(Difference(linear, tape) < 1e-15);
+    return failed;
+}
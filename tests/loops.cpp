@@ -0,0 +1,129 @@
+/**********************
+Tests of algebraic loops solved by Newton iterations, and of how they are
+ found and torn.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// y=1-0.5*y, and y=2/3.
+void Linear() {
+    Simulator sim(1);
+    FUConstant(c, &sim); FUSum(s, &sim); FUGain(g, &sim); FUOutput(o, &sim);
+    c->Set_OutValue(1);
+    sim.connectU(c, s); sim.connectU(g, s); s->Set_InputGain(-1);
+    sim.connectU(s, g); g->Set_Gain(0.5);
+    sim.connectU(s, o);
+    sim.Initialize();
+    CHECK(sim.Get_LoopCount() == 1);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(s->Get_OutValue(), 2.0/3, 1e-12);
+}
+
+// y=cos(y), whose root is the Dottie number.
+void Nonlinear() {
+    Simulator sim(1);
+    FUFcn(f, &sim); FUSum(s, &sim); FUOutput(o, &sim);
+    f->Set_Function([](double u){ return cos(u); });
+    sim.connectU(s, f); sim.connectU(f, s);
+    sim.connectU(s, o);
+    sim.Initialize();
+    CHECK(sim.Get_LoopCount() == 1);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(s->Get_OutValue(), 0.7390851332151607, 1e-10);
+}
+
+// x'=-y, y=x-0.5*y, so x'=-2x/3 and x(t)=exp(-2t/3).
+void WithIntegrator() {
+    Simulator sim(1);
+    FUIntegrator(x, &sim); FUSum(s, &sim); FUGain(g, &sim); FUGain(n, &sim); FUOutput(o, &sim);
+    x->Set_InitialValue(1);
+    sim.connectU(x, s); sim.connectU(g, s); s->Set_InputGain(-1);
+    sim.connectU(s, g); g->Set_Gain(0.5);
+    sim.connectU(s, n); n->Set_Gain(-1); sim.connectU(n, x);
+    sim.connectU(x, o);
+    sim.Initialize();
+    CHECK(sim.Get_LoopCount() == 1);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(x->Get_OutValue(), exp(-2.0/3), 1e-9);
+}
+
+// y1=1-0.5*y1 and y2=2-y2 don't share modules, so they're 2 loops.
+void Independent() {
+    Simulator sim(1);
+    FUConstant(c1, &sim); FUSum(s1, &sim); FUGain(g1, &sim);
+    FUConstant(c2, &sim); FUSum(s2, &sim); FUGain(g2, &sim);
+    c1->Set_OutValue(1); c2->Set_OutValue(2);
+    sim.connectU(c1, s1); sim.connectU(g1, s1); s1->Set_InputGain(-1);
+    sim.connectU(s1, g1); g1->Set_Gain(0.5);
+    sim.connectU(c2, s2); sim.connectU(g2, s2); s2->Set_InputGain(-1);
+    sim.connectU(s2, g2);
+    FUOutput(o1, &sim); FUOutput(o2, &sim);
+    sim.connectU(s1, o1); sim.connectU(s2, o2);
+    sim.Initialize();
+    CHECK(sim.Get_LoopCount() == 2);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(s1->Get_OutValue(), 2.0/3, 1e-12);
+    CHECK_NEAR(s2->Get_OutValue(), 1, 1e-12);
+}
+
+// a=1-0.5*a-0.2*b and b=2-0.3*a-0.25*b, whose cycles can't be broken by
+//  tearing one module, so both are torn.
+void Nested() {
+    Simulator sim(1);
+    FUConstant(c1, &sim); FUConstant(c2, &sim); FUSum(a, &sim); FUSum(b, &sim);
+    FUGain(aa, &sim); FUGain(ba, &sim); FUGain(ab, &sim); FUGain(bb, &sim);
+    c1->Set_OutValue(1); c2->Set_OutValue(2);
+    aa->Set_Gain(-0.5); ba->Set_Gain(-0.2); ab->Set_Gain(-0.3); bb->Set_Gain(-0.25);
+    sim.connectU(a, aa); sim.connectU(b, ba); sim.connectU(a, ab); sim.connectU(b, bb);
+    sim.connectU(c1, a); sim.connectU(aa, a); sim.connectU(ba, a);
+    sim.connectU(c2, b); sim.connectU(ab, b); sim.connectU(bb, b);
+    FUOutput(o, &sim); sim.connectU(b, o);
+    sim.Initialize();
+    CHECK(sim.Get_LoopCount() == 1);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(a->Get_OutValue(), 0.85/1.815, 1e-12);
+    CHECK_NEAR(b->Get_OutValue(), 2.7/1.815, 1e-12);
+}
+
+// y1=1-0.5*y1 feeds y2=y1-y2, so y2=1/3 after the first loop is solved.
+void Chained() {
+    Simulator sim(1);
+    FUConstant(c, &sim); FUSum(s1, &sim); FUGain(g1, &sim); FUSum(s2, &sim);
+    c->Set_OutValue(1);
+    sim.connectU(c, s1); sim.connectU(g1, s1); s1->Set_InputGain(-1);
+    sim.connectU(s1, g1); g1->Set_Gain(0.5);
+    sim.connectU(s1, s2); sim.connectU(s2, s2); s2->Set_InputGain(-1);
+    FUOutput(o, &sim); sim.connectU(s2, o);
+    sim.Initialize();
+    CHECK(sim.Get_LoopCount() == 2);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(s2->Get_OutValue(), 1.0/3, 1e-12);
+}
+
+// y=1+y has no solution, so the Jacobian is singular, which is warned and
+//  the simulation goes on.
+void Singular() {
+    Simulator sim(1);
+    FUConstant(c, &sim); FUSum(s, &sim); FUIntegrator(x, &sim);
+    c->Set_OutValue(1);
+    sim.connectU(c, s); sim.connectU(s, s);
+    sim.connectU(c, x);
+    FUOutput(o, &sim); sim.connectU(s, o);
+    sim.Initialize();
+    CHECK(sim.Get_LoopCount() == 1);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(sim.Get_t(), 1, 1e-9);
+    CHECK_NEAR(x->Get_OutValue(), 1, 1e-9);
+}
+
+int main() {
+    Linear();
+    Nonlinear();
+    WithIntegrator();
+    Independent();
+    Nested();
+    Chained();
+    Singular();
+    return failed;
+}
@@ -0,0 +1,67 @@
+/**********************
+Tests of the graph optimizer: folding constants, merging gains and removing
+ unreachable modules don't change results.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x'=3*(c1+c2)-2*0.5*x, and a chain of gains which no OUTPUT module reads.
+// c1, c2, cs and cg are folded into a new CONSTANT module, g1 and g2 are
+//  merged into s, and d1 and d2 are unread, so 8 modules are removed.
+// If "ingain" isn't negative, the input gain of s from g2 is changed to it.
+double Run(bool optimize, uint *removed=nullptr, double ingain=-1) {
+    Simulator sim(2);
+    FUConstant(c1, &sim); FUConstant(c2, &sim); FUSum(cs, &sim); FUGain(cg, &sim);
+    FUIntegrator(x, &sim); FUGain(g1, &sim); FUGain(g2, &sim); FUSum(s, &sim); FUOutput(o, &sim);
+    FUGain(d1, &sim); FUGain(d2, &sim);
+    c1->Set_OutValue(1.5); c2->Set_OutValue(0.25);
+    sim.connectU(c1, cs); sim.connectU(c2, cs);
+    sim.connectU(cs, cg); cg->Set_Gain(3);
+    sim.connectU(x, g1); g1->Set_Gain(0.5);
+    sim.connectU(g1, g2); g2->Set_Gain(2);
+    sim.connectU(cg, s); sim.connectU(g2, s); s->Set_InputGain(-1);
+    sim.connectU(s, x); sim.connectU(x, o);
+    sim.connectU(x, d1); sim.connectU(d1, d2);
+    sim.Set_EnableOptimize(optimize);
+    sim.Initialize();
+    if (ingain >= 0) {
+        // The parameter is the gain set by users, and merged gains are kept.
+        int h = sim.Get_Parameter(s, "ingain", 1);
+        CHECK(h >= 0);
+        CHECK(sim.Get_ParameterValue(h) == -1);
+        sim.Set_Parameter(h, ingain);
+        sim.Simulation_Reset();
+        CHECK(sim.Get_ParameterValue(h) == ingain);
+    }
+    CHECK(sim.Simulate() == 0);
+    if (removed) *removed = sim.Get_RemovedCount();
+    return x->Get_OutValue();
+}
+
+// Constants set tunable aren't folded, so their parameters change the results.
+void Tunable() {
+    Simulator sim(1);
+    FUConstant(c, &sim); FUGain(g, &sim); FUIntegrator(x, &sim); FUOutput(o, &sim);
+    c->Set_OutValue(1); c->Set_Tunable();
+    sim.connectU(c, g); g->Set_Gain(2); sim.connectU(g, x); sim.connectU(x, o);
+    sim.Set_EnableOptimize();
+    sim.Initialize();
+    int h = sim.Get_Parameter(c, "value");
+    CHECK(h >= 0);
+    sim.Set_Parameter(h, 3);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(x->Get_OutValue(), 6, 1e-9);
+}
+
+int main() {
+    uint removed;
+    double x0 = Run(false);
+    double x1 = Run(true, &removed);
+    CHECK_NEAR(x0, 5.25*(1-exp(-2.0)), 1e-9);
+    CHECK_NEAR(x1, x0, 1e-12);
+    CHECK(removed == 8);
+    CHECK_NEAR(Run(true, nullptr, 0.5), Run(false, nullptr, 0.5), 1e-9);
+    Tunable();
+    return failed;
+}
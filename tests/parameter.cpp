@@ -0,0 +1,86 @@
+/**********************
+Tests of parameter handles, which change gains of the tape, lanes, algebraic
+ loops and the compiled model without re-initialization.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x'=g*1, so x(1)=g, and g is changed to 3 at 0.5 s in the last run.
+void Tape(bool jit) {
+    Simulator sim(1);
+    FUConstant(c, &sim); FUGain(g, &sim); FUIntegrator(x, &sim); FUOutput(o, &sim);
+    c->Set_OutValue(1); g->Set_Gain(2);
+    sim.connectU(c, g); sim.connectU(g, x); sim.connectU(x, o);
+    if (jit) sim.Set_EnableJIT(true, "jit");
+    sim.Initialize();
+    bool compiled = sim.Get_EnableJIT();
+    int h = sim.Get_Parameter(g, "gain");
+    CHECK(h >= 0);
+    CHECK(sim.Get_ParameterValue(h) == 2);
+    // Getting a handle or setting the same value keeps the compiled model.
+    sim.Set_Parameter(h, 2);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(x->Get_OutValue(), 2, 1e-9);
+    CHECK(sim.Get_EnableJIT() == compiled);
+
+    sim.Simulation_Reset();
+    while (sim.Get_t() < 0.5-0.0005) sim.Simulate_OneStep();
+    sim.Set_Parameter(h, 3);
+    while (sim.Get_t() < 1-0.0005) sim.Simulate_OneStep();
+    CHECK_NEAR(x->Get_OutValue(), 2.5, 1e-9);
+    CHECK(sim.Get_ParameterValue(h) == 3);
+    CHECK(!sim.Get_EnableJIT());
+}
+
+// The value is applied to every lane.
+void Lanes() {
+    Simulator sim(1);
+    FUConstant(c, &sim); FUGain(g, &sim); FUIntegrator(x, &sim); FUOutput(o, &sim);
+    c->Set_OutValue(1); g->Set_Gain(2);
+    sim.connectU(c, g); sim.connectU(g, x); sim.connectU(x, o);
+    sim.Set_Ensemble(3);
+    sim.Initialize();
+    int h = sim.Get_Parameter(g, "gain");
+    sim.Set_Parameter(h, 4);
+    CHECK(sim.Simulate() == 0);
+    for (uint l=0; l<3; ++l)
+        CHECK_NEAR(sim.Get_LaneData(o, l).back(), 4, 1e-9);
+}
+
+// y=1-a*y, so y=1/(1+a), and the loop is updated by modules themselves.
+void Loop() {
+    Simulator sim(1);
+    FUConstant(c, &sim); FUSum(s, &sim); FUGain(a, &sim); FUOutput(o, &sim);
+    c->Set_OutValue(1); a->Set_Gain(0.5);
+    sim.connectU(c, s); sim.connectU(a, s); s->Set_InputGain(-1);
+    sim.connectU(s, a); sim.connectU(s, o);
+    sim.Initialize();
+    int h = sim.Get_Parameter(a, "gain");
+    CHECK(h >= 0);
+    sim.Set_Parameter(h, 1);
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(s->Get_OutValue(), 0.5, 1e-12);
+}
+
+// g1 is only read inside a linear block, so its gain can't be changed.
+void Linear() {
+    Simulator sim(1);
+    FUIntegrator(x, &sim); FUGain(g1, &sim); FUSum(s, &sim); FUOutput(o, &sim);
+    x->Set_InitialValue(1); g1->Set_Gain(-2);
+    sim.connectU(x, g1); sim.connectU(g1, s); sim.connectU(x, s);
+    sim.connectU(s, x); sim.connectU(x, o);
+    sim.Set_EnableLinear();
+    sim.Initialize();
+    CHECK(sim.Get_LinearCount() > 0);
+    CHECK(sim.Get_Parameter(g1, "gain") == -1);
+}
+
+int main() {
+    Tape(false);
+    Tape(true);
+    Lanes();
+    Loop();
+    Linear();
+    return failed;
+}
@@ -0,0 +1,59 @@
+/**********************
+Tests of real-time pacing, which counts paced steps and steps overrunning
+ their deadlines.
+**********************/
+#include <chrono>
+#include <thread>
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// 20 steps of 10 ms, and the step from 0.05 s stalls for 25 ms when "stall"
+//  is set. Deadlines don't shift after it, so the stalled step and the next one
+//  overrun, and pacing catches up in the step after them.
+int main() {
+    static bool stall = true;
+    Simulator sim(0.2);
+    FUIntegrator(x, &sim); FUFcn(f, &sim); FUOutput(o, &sim);
+    f->Set_Function([](double u){
+        if (stall && (u >= 0.05)) {
+            stall = false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+        }
+        return 1.0;
+    });
+    sim.connectU(x, f); sim.connectU(f, x); sim.connectU(x, o);
+    sim.Set_SimStep(0.01);
+    sim.Set_EnableRealTime();
+    sim.Initialize();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK(sim.Simulate() == 0);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    RealTimeStats stats = sim.Get_RealTimeStats();
+    CHECK(!stall);
+    CHECK(stats.steps == sim.Get_StepCount());
+    CHECK(stats.steps == 20);
+    CHECK((stats.overruns >= 2) && (stats.overruns <= 3));
+    CHECK(stats.max >= 0.025);
+    CHECK(stats.p50 < 0.005);
+    CHECK(stats.p50 <= stats.p99);
+    CHECK(stats.p99 <= stats.max);
+    CHECK(elapsed >= 0.19);
+
+    // Counters are cleared by reset, and steps keep their deadlines.
+    sim.Simulation_Reset();
+    stats = sim.Get_RealTimeStats();
+    CHECK((stats.steps == 0) && (stats.overruns == 0) && (stats.max == 0));
+    CHECK(sim.Simulate() == 0);
+    stats = sim.Get_RealTimeStats();
+    CHECK(stats.steps == 20);
+    CHECK(stats.overruns == 0);
+
+    // Steps aren't paced or counted without real time.
+    sim.Set_EnableRealTime(false);
+    sim.Simulation_Reset();
+    CHECK(sim.Simulate() == 0);
+    CHECK(sim.Get_RealTimeStats().steps == 0);
+    return failed;
+}
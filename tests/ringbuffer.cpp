@@ -0,0 +1,78 @@
+/**********************
+Tests of ring buffers, whose spans hold the latest values in order as the
+ buffer fills up and wraps around.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// Whether "ring" holds exactly the values "first", "first"+1, ..., "last"-1
+//  by its spans, "operator[]" and "Copy()".
+bool Holds(const RingBuffer &ring, uint first, uint last) {
+    TraceView older, newer;
+    ring.Get_Spans(older, newer);
+    std::vector<double> spans(older.begin(), older.end()), copy;
+    spans.insert(spans.end(), newer.begin(), newer.end());
+    ring.Copy(copy);
+    bool ok = (ring.Size() == last-first) && (spans.size() == last-first) && (copy == spans);
+    for (uint i=first; ok && (i<last); ++i)
+        ok = (spans[i-first] == i) && (ring[i-first] == i);
+    return ok;
+}
+
+// Values 0, 1, ... are pushed to a buffer of 5 until it wraps around twice.
+void Wrap() {
+    RingBuffer ring(5);
+    CHECK(Holds(ring, 0, 0));
+    for (uint n=1; n<=13; ++n) {
+        ring.Push(n-1);
+        CHECK(Holds(ring, n<5 ? 0 : n-5, n));
+        TraceView older, newer;
+        ring.Get_Spans(older, newer);
+        // The newer span is empty until the buffer is full, and then it
+        //  holds the values written over the oldest ones.
+        CHECK(newer.size == (n<5 ? 0 : n%5));
+    }
+    ring.Clear();
+    CHECK(Holds(ring, 0, 0));
+    ring.Push(0);
+    CHECK(Holds(ring, 0, 1));
+}
+
+// The latest values are kept when the capacity is changed.
+void Capacity() {
+    RingBuffer ring(4);
+    for (uint i=0; i<7; ++i) ring.Push(i);
+    ring.Set_Capacity(6);
+    CHECK(Holds(ring, 3, 7));
+    ring.Push(7); ring.Push(8); ring.Push(9);
+    CHECK(Holds(ring, 4, 10));
+    ring.Set_Capacity(3);
+    CHECK((ring.Capacity() == 3) && Holds(ring, 7, 10));
+    ring.Push(10);
+    CHECK(Holds(ring, 8, 11));
+    ring.Set_Capacity(0);
+    CHECK(Holds(ring, 0, 0));
+}
+
+// An OUTPUT module storing 100 values holds the last 100 values stored
+//  without limitation.
+void Output() {
+    Simulator sim(1);
+    FUIntegrator(x, &sim); FUConstant(c, &sim); FUOutput(all, &sim); FUOutput(last, &sim);
+    sim.connectU(c, x); sim.connectU(x, all); sim.connectU(x, last);
+    last->Set_MaxDataStorage(100);
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    std::vector<double> data = all->Get_StoredData(), ring;
+    last->Get_RingData().Copy(ring);
+    CHECK(data.size() > 100);
+    CHECK(ring == std::vector<double>(data.end()-100, data.end()));
+}
+
+int main() {
+    Wrap();
+    Capacity();
+    Output();
+    return failed;
+}
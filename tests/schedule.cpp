@@ -0,0 +1,46 @@
+/**********************
+Tests of the event calendar, which enables discrete modules at their sample
+ hits. Hits at the beginning of a step are seen by outputs at its end.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// z1 and z2 sample time t every 0.1 s and 0.25 s, and d counts hits of 0.2 s.
+void Run(bool tape, std::vector<double> &values) {
+    Simulator sim(1);
+    FUInput(in, &sim); FUZOH(z1, &sim); FUZOH(z2, &sim);
+    FUUnitDelay(d, &sim); FUSum(s, &sim); FUConstant(c, &sim);
+    FUOutput(o1, &sim); FUOutput(o2, &sim); FUOutput(o3, &sim);
+    in->Set_Function([](double t){ return t; });
+    z1->Set_SampleTime(0.1); z2->Set_SampleTime(0.25); d->Set_SampleTime(0.2);
+    c->Set_OutValue(1);
+    sim.connectU(in, z1); sim.connectU(in, z2);
+    sim.connectU(d, s); sim.connectU(c, s); sim.connectU(s, d);
+    sim.connectU(z1, o1); sim.connectU(z2, o2); sim.connectU(d, o3);
+    sim.Set_EnableTape(tape);
+    sim.Initialize();
+    const double h = 0.001;
+    uint bad = 0;
+    values.clear();
+    while (sim.Get_t() < 1-0.5*h) {
+        double t0 = sim.Get_t();
+        sim.Simulate_OneStep();
+        if (fabs(z1->Get_OutValue() - 0.1*floor(t0/0.1+1e-6)) > 1e-9) bad++;
+        if (fabs(z2->Get_OutValue() - 0.25*floor(t0/0.25+1e-6)) > 1e-9) bad++;
+        if (d->Get_OutValue() != floor(t0/0.2+1e-6)) bad++;
+        values.push_back(z1->Get_OutValue());
+        values.push_back(z2->Get_OutValue());
+        values.push_back(d->Get_OutValue());
+    }
+    CHECK(bad == 0);
+    CHECK(values.size() == 3000);
+}
+
+int main() {
+    std::vector<double> v1, v2;
+    Run(true, v1);
+    Run(false, v2);
+    CHECK(v1 == v2);
+    return failed;
+}
@@ -0,0 +1,98 @@
+/**********************
+Tests of output sinks, which deliver exactly the samples written to them, in
+ order, including those written after a flush and those left when closed.
+**********************/
+#include <cstdio>
+#include <memory>
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// Write "n" samples (i, 0.5*i) from "i0", which fill chunks of 4 pairs.
+void Write(OutputSink *sink, uint i0, uint n) {
+    for (uint i=i0; i<i0+n; ++i) sink->Write(i, 0.5*i);
+}
+// Whether "data" holds exactly pairs (i, 0.5*i) for i in [0, n).
+bool Exact(const std::vector<double> &data, uint n) {
+    if (data.size() != 2*n) return false;
+    for (uint i=0; i<n; ++i)
+        if ((data[2*i] != i) || (data[2*i+1] != 0.5*i)) return false;
+    return true;
+}
+std::vector<double> ReadFile(const char *name) {
+    std::vector<double> data;
+    FILE *f = fopen(name, "rb");
+    if (!f) return data;
+    double v;
+    while (fread(&v, sizeof(double), 1, f) == 1) data.push_back(v);
+    fclose(f);
+    return data;
+}
+
+// Partial chunks are delivered by "Flush()", and only 2 chunks make the
+//  simulation thread wait for the background thread.
+void Callback() {
+    std::vector<double> got;
+    std::shared_ptr<CallbackSink> sink = std::make_shared<CallbackSink>(
+        [&got](const double *data, uint n){ got.insert(got.end(), data, data+2*n); }, 4, 2);
+    Write(sink.get(), 0, 10);
+    sink->Flush();
+    CHECK(Exact(got, 10));
+    Write(sink.get(), 10, 7);
+    sink->Flush();
+    CHECK(Exact(got, 17));
+    // Samples left in a partial chunk are delivered when the sink is closed.
+    Write(sink.get(), 17, 2);
+    sink.reset();
+    CHECK(Exact(got, 19));
+}
+
+void File() {
+    const char *name = "sinks.bin";
+    FileSink *sink = new FileSink(name, 4, 2);
+    Write(sink, 0, 9);
+    sink->Flush();
+    CHECK(Exact(ReadFile(name), 9));
+    Write(sink, 9, 6);
+    sink->Flush();
+    CHECK(Exact(ReadFile(name), 15));
+    // The file is rewritten after reset.
+    sink->Reset();
+    Write(sink, 0, 3);
+    delete sink;
+    CHECK(Exact(ReadFile(name), 3));
+    remove(name);
+}
+
+// Samples of an OUTPUT module are the same with every sink as in memory.
+void Output() {
+    Simulator sim(1);
+    FUIntegrator(x, &sim); FUConstant(c, &sim);
+    FUOutput(o1, &sim); FUOutput(o2, &sim); FUOutput(o3, &sim);
+    sim.connectU(c, x); sim.connectU(x, o1); sim.connectU(x, o2); sim.connectU(x, o3);
+    std::shared_ptr<MemorySink> mem = std::make_shared<MemorySink>();
+    std::vector<double> got;
+    o2->Set_Sink(mem);
+    o3->Set_Sink(std::make_shared<CallbackSink>(
+        [&got](const double *data, uint n){ got.insert(got.end(), data, data+2*n); }, 64, 2));
+    sim.Initialize();
+    for (int run=0; run<2; ++run) {
+        got.clear();
+        CHECK(sim.Simulate() == 0);
+        std::vector<double> v = o1->Get_StoredData();
+        CHECK(mem->Get_Data() == v);
+        CHECK(got.size() == 2*v.size());
+        bool same = true;
+        for (uint i=0; i<v.size(); ++i)
+            same = same && (got[2*i] == mem->Get_Time()[i]) && (got[2*i+1] == v[i]);
+        CHECK(same);
+        sim.Simulation_Reset();
+    }
+}
+
+int main() {
+    Callback();
+    File();
+    Output();
+    return failed;
+}
@@ -0,0 +1,47 @@
+/**********************
+Tests of ODE solvers against known solutions.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x'=-x, x(0)=1, and x(t)=exp(-t).
+double Decay(int solver, double step, uint *steps=nullptr) {
+    Simulator sim(2);
+    FUIntegrator(x, &sim); FUGain(g, &sim); FUOutput(o, &sim);
+    x->Set_InitialValue(1);
+    sim.connectU(x, g); g->Set_Gain(-1); sim.connectU(g, x);
+    sim.connectU(x, o);
+    sim.Set_SimStep(step);
+    sim.Set_Solver(solver);
+    sim.Set_Tolerance(1e-9, 1e-12);
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(sim.Get_t(), 2, 1e-9);
+    if (steps) *steps = sim.Get_StepCount();
+    return x->Get_OutValue();
+}
+
+// x''=-x, x(0)=1, x'(0)=0, and x(t)=cos(t).
+void Oscillator() {
+    Simulator sim(2*M_PI);
+    FUIntegrator(x1, &sim); FUIntegrator(x2, &sim); FUGain(g, &sim); FUOutput(o, &sim);
+    x1->Set_InitialValue(1);
+    sim.connectU(x2, x1); sim.connectU(x1, g); g->Set_Gain(-1); sim.connectU(g, x2);
+    sim.connectU(x1, o);
+    sim.Set_Solver(SOLVER_RK45);
+    sim.Set_Tolerance(1e-9, 1e-12);
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    CHECK_NEAR(x1->Get_OutValue(), 1, 1e-7);
+    CHECK_NEAR(x2->Get_OutValue(), 0, 1e-7);
+}
+
+int main() {
+    uint steps;
+    CHECK_NEAR(Decay(SOLVER_RK4, 0.01), exp(-2.0), 1e-10);
+    CHECK_NEAR(Decay(SOLVER_RK45, 0.01, &steps), exp(-2.0), 1e-8);
+    CHECK(steps < 200);
+    Oscillator();
+    return failed;
+}
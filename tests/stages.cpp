@@ -0,0 +1,42 @@
+/**********************
+Tests of the stage schedule, which updates modules shared by integrators once
+ per stage of a solver.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+static uint calls = 0;
+
+// x1'=-x1 and x2'=-2*x1, where f=-x1 is read by both integrators.
+void Run(bool tape, double &x1, double &x2) {
+    Simulator sim(1);
+    FUIntegrator(i1, &sim); FUIntegrator(i2, &sim); FUFcn(f, &sim);
+    FUGain(g1, &sim); FUGain(g2, &sim); FUOutput(o, &sim);
+    f->Set_Function([](double u){ calls++; return -u; });
+    i1->Set_InitialValue(1); g2->Set_Gain(2);
+    sim.connectU(i1, f); sim.connectU(f, g1); sim.connectU(f, g2);
+    sim.connectU(g1, i1); sim.connectU(g2, i2); sim.connectU(i2, o);
+    sim.Set_EnableTape(tape);
+    sim.Initialize();
+    CHECK(sim.Get_StageCount() == 3);
+    // Four stages of RK4 in every step after the first one, which also
+    //  evaluates initial outputs.
+    sim.Simulate_OneStep();
+    calls = 0;
+    for (int k=1; k<1000; ++k) sim.Simulate_OneStep();
+    CHECK(calls == 4*999);
+    x1 = i1->Get_OutValue();
+    x2 = i2->Get_OutValue();
+}
+
+int main() {
+    double a1, a2, b1, b2;
+    Run(true, a1, a2);
+    Run(false, b1, b2);
+    CHECK_NEAR(a1, exp(-1.0), 1e-12);
+    CHECK_NEAR(a2, 2*exp(-1.0)-2, 1e-12);
+    CHECK(a1 == b1);
+    CHECK(a2 == b2);
+    return failed;
+}
@@ -0,0 +1,55 @@
+/**********************
+Tests of saving and restoring simulation states, which continue bit for bit
+ like the simulation they were saved from.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+void RoundTrip(int solver) {
+    Simulator sim(4);
+    FUIntegrator(x, &sim); FUNoise(n, &sim); FUUnitDelay(d, &sim);
+    FUTransportDelay(td, &sim); FUInput(in, &sim); FUSum(s, &sim); FUOutput(o, &sim);
+    x->Set_InitialValue(1);
+    n->Set_SampleTime(0.1);
+    d->Set_SampleTime(0.2);
+    td->Set_InitialValue(0); td->Set_DelayTime(0.3);
+    std::vector<double> data;
+    for (int i=0; i<200; ++i) data.push_back(sin(i*0.3));
+    in->Set_Continuous(false); in->Set_SampleTime(0.05); in->Set_InputData(data);
+    sim.connectU(x, d); sim.connectU(x, td);
+    sim.connectU(d, s); s->Set_InputGain(-1);
+    sim.connectU(td, s); s->Set_InputGain(-0.5);
+    sim.connectU(n, s); sim.connectU(in, s);
+    sim.connectU(s, x); sim.connectU(x, o);
+    sim.Set_EnableStore(false);
+    sim.Set_Solver(solver);
+    sim.Initialize();
+    while (sim.Get_t() < 1.5) sim.Simulate_OneStep();
+    std::vector<u8> state = sim.SaveState();
+    double t = sim.Get_t();
+    while (sim.Get_t() < 4) sim.Simulate_OneStep();
+    double y = o->Get_OutValue();
+
+    // Restore into the same simulator twice, then into a copy of it.
+    for (int k=0; k<2; ++k) {
+        sim.RestoreState(state);
+        CHECK(sim.Get_t() == t);
+        while (sim.Get_t() < 4) sim.Simulate_OneStep();
+        CHECK(o->Get_OutValue() == y);
+    }
+    Simulator *copy = sim.Clone();
+    CHECK(copy != nullptr);
+    if (!copy) return;
+    copy->RestoreState(state);
+    while (copy->Get_t() < 4) copy->Simulate_OneStep();
+    CHECK(copy->Get_Module(o)->Get_OutValue() == y);
+    delete copy;
+}
+
+int main() {
+    RoundTrip(SOLVER_RK4);
+    RoundTrip(SOLVER_RK45);
+    RoundTrip(SOLVER_BDF2);
+    return failed;
+}
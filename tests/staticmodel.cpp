@@ -0,0 +1,123 @@
+/**********************
+Tests of the compile-time model, whose states are identical to those of
+ Simulator with the RK4 solver after every step.
+**********************/
+#include "simucpp.hpp"
+#include "staticmodel.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// x1'=x2, x2'=u-0.5*x2-x1, and u is a discrete PI controller of the sampled x1.
+typedef StaticModel<
+    SConstant,          // 0: reference
+    SIntegrator<2>,     // 1: x1
+    SIntegrator<8>,     // 2: x2
+    SZOH<1>,            // 3: sampled x1
+    SSum<0, 3>,         // 4: error
+    SUnitDelay<6>,      // 5: last accumulated error
+    SSum<5, 4>,         // 6: accumulated error
+    SSum<4, 6>,         // 7: u
+    SSum<7, 2, 1>       // 8: x2'
+> PILoop;
+
+void PI() {
+    PILoop m(5);
+    m.Get_Block<0>().Set_OutValue(1);
+    m.Get_Block<3>().Set_SampleTime(0.01);
+    m.Get_Block<4>().Set_InputGain(-1, 1);
+    m.Get_Block<5>().Set_SampleTime(0.01);
+    m.Get_Block<6>().Set_InputGain(0.01, 1);
+    m.Get_Block<7>().Set_InputGain(2, 0);
+    m.Get_Block<7>().Set_InputGain(1, 1);
+    m.Get_Block<8>().Set_InputGain(-0.5, 1);
+    m.Get_Block<8>().Set_InputGain(-1, 2);
+    m.Simulation_Reset();
+
+    Simulator sim(5);
+    FUConstant(r, &sim); FUIntegrator(int1, &sim); FUIntegrator(int2, &sim);
+    FUZOH(zoh, &sim); FUSum(err, &sim); FUUnitDelay(delay, &sim);
+    FUSum(acc, &sim); FUSum(u, &sim); FUSum(dx2, &sim); FUOutput(out, &sim);
+    r->Set_OutValue(1);
+    zoh->Set_SampleTime(0.01);
+    delay->Set_SampleTime(0.01);
+    sim.connectU(int2, int1);
+    sim.connectU(dx2, int2);
+    sim.connectU(int1, zoh);
+    sim.connectU(r, err);
+    sim.connectU(zoh, err); err->Set_InputGain(-1);
+    sim.connectU(acc, delay);
+    sim.connectU(delay, acc);
+    sim.connectU(err, acc); acc->Set_InputGain(0.01);
+    sim.connectU(err, u); u->Set_InputGain(2);
+    sim.connectU(acc, u);
+    sim.connectU(u, dx2);
+    sim.connectU(int2, dx2); dx2->Set_InputGain(-0.5);
+    sim.connectU(int1, dx2); dx2->Set_InputGain(-1);
+    sim.connectU(int1, out);
+    sim.Set_Solver(SOLVER_RK4);
+    sim.Set_EnableStore(false);
+    sim.Initialize();
+
+    uint bad = 0, steps = 0;
+    while (sim.Get_t() < 5-0.0005) {
+        sim.Simulate_OneStep();
+        m.Simulate_OneStep();
+        steps++;
+        if ((m.Get_t() != sim.Get_t()) ||
+            (m.Get_OutValue<1>() != int1->Get_OutValue()) ||
+            (m.Get_OutValue<2>() != int2->Get_OutValue()) ||
+            (m.Get_OutValue<3>() != zoh->Get_OutValue()) ||
+            (m.Get_OutValue<5>() != delay->Get_OutValue()))
+            bad++;
+    }
+    CHECK(steps == 5000);
+    CHECK(bad == 0);
+    // The whole simulation of a new model ends at the same state.
+    PILoop m2 = m;
+    m2.Simulation_Reset();
+    m2.Simulate();
+    CHECK(m2.Get_OutValue<1>() == int1->Get_OutValue());
+    CHECK(m2.Get_OutValue<2>() == int2->Get_OutValue());
+}
+
+// y'=2*(1-y), from the example of the header file.
+typedef StaticModel<
+    SConstant,          // 0: reference
+    SSum<0, 3>,         // 1: error
+    SGain<1>,           // 2: controller
+    SIntegrator<2>,     // 3: y
+    SZOH<3>             // 4: sampled y
+> Loop;
+
+void Gain() {
+    Loop m(2, 0.01);
+    m.Get_Block<0>().Set_OutValue(1);
+    m.Get_Block<1>().Set_InputGain(-1, 1);
+    m.Get_Block<2>().Set_Gain(2);
+    m.Get_Block<4>().Set_SampleTime(0.1);
+    m.Simulation_Reset();
+    m.Simulate();
+
+    Simulator sim(2);
+    FUConstant(r, &sim); FUSum(e, &sim); FUGain(g, &sim);
+    FUIntegrator(y, &sim); FUZOH(z, &sim); FUOutput(o, &sim);
+    r->Set_OutValue(1);
+    g->Set_Gain(2);
+    z->Set_SampleTime(0.1);
+    sim.connectU(r, e); sim.connectU(y, e); e->Set_InputGain(-1);
+    sim.connectU(e, g); sim.connectU(g, y); sim.connectU(y, z); sim.connectU(z, o);
+    sim.Set_SimStep(0.01);
+    sim.Set_Solver(SOLVER_RK4);
+    sim.Set_EnableStore(false);
+    sim.Initialize();
+    sim.Simulate();
+    CHECK(m.Get_OutValue<3>() == y->Get_OutValue());
+    CHECK(m.Get_OutValue<4>() == z->Get_OutValue());
+    CHECK_NEAR(m.Get_OutValue<3>(), 1-exp(-4.0), 1e-8);
+}
+
+int main() {
+    PI();
+    Gain();
+    return failed;
+}
@@ -0,0 +1,50 @@
+/**********************
+Tests of the stage schedule updated on several threads, whose results are
+ identical to those of one thread.
+**********************/
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// "n" coupled oscillators x1'=x2, x2'=u-0.5*x2-x1-0.1*x1^3-0.01*y, where y
+//  is the sum of all x1, so every level has "n" modules.
+std::vector<double> Run(int solver, uint threads, int n=64) {
+    Simulator sim(2);
+    FUInput(in, &sim); FUSum(total, &sim); FUOutput(out, &sim);
+    in->Set_Function([](double t){ return t<1 ? 1.0 : 0.0; });
+    std::vector<UIntegrator*> xs;
+    for (int i=0; i<n; ++i) {
+        FUIntegrator(x1, &sim); FUIntegrator(x2, &sim); FUSum(sum, &sim);
+        FUFcn(cube, &sim); FUGain(damp, &sim);
+        x1->Set_InitialValue(0.01*i);
+        cube->Set_Function([](double u){ return u*u*u; });
+        damp->Set_Gain(0.5);
+        sim.connectU(x1, cube); sim.connectU(x2, damp);
+        sim.connectU(in, sum);
+        sim.connectU(damp, sum); sum->Set_InputGain(-1);
+        sim.connectU(x1, sum); sum->Set_InputGain(-1);
+        sim.connectU(cube, sum); sum->Set_InputGain(-0.1);
+        sim.connectU(total, sum); sum->Set_InputGain(-0.01);
+        sim.connectU(sum, x2); sim.connectU(x2, x1);
+        sim.connectU(x1, total);
+        xs.push_back(x1);
+    }
+    sim.connectU(total, out);
+    sim.Set_Solver(solver);
+    sim.Set_Threads(threads, 1);
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    std::vector<double> x;
+    for (UIntegrator *m: xs) x.push_back(m->Get_OutValue());
+    x.push_back(sim.Get_t());
+    return x;
+}
+
+int main() {
+    for (int solver: {SOLVER_RK4, SOLVER_RK45}) {
+        std::vector<double> serial = Run(solver, 1);
+        CHECK(Run(solver, 2) == serial);
+        CHECK(Run(solver, 4) == serial);
+    }
+    return failed;
+}
@@ -0,0 +1,105 @@
+/**********************
+Tests of trace files, which are read back exactly as they are saved, and
+ rejected when their headers are truncated or corrupt.
+**********************/
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+std::vector<char> ReadBytes(const char *name) {
+    std::vector<char> bytes;
+    FILE *f = fopen(name, "rb");
+    if (!f) return bytes;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf+n);
+    fclose(f);
+    return bytes;
+}
+void WriteBytes(const char *name, const std::vector<char> &bytes) {
+    FILE *f = fopen(name, "wb");
+    fwrite(bytes.data(), 1, bytes.size(), f);
+    fclose(f);
+}
+bool Same(TraceView view, const std::vector<double> &data) {
+    return (view.size == data.size()) && std::equal(data.begin(), data.end(), view.begin());
+}
+// Whether "bytes" saved to a file are rejected.
+bool Rejected(const std::vector<char> &bytes) {
+    WriteBytes("trace_bad.bin", bytes);
+    TraceReader reader("trace_bad.bin");
+    bool rejected = !reader.Is_Open() && (reader.Get_Count() == 0)
+        && (reader.Get_Time().size == 0) && (reader.Get_Signal("x").size == 0);
+    remove("trace_bad.bin");
+    return rejected;
+}
+
+int main() {
+    const char *name = "trace.bin";
+    Simulator sim(1);
+    FUIntegrator(i, &sim); FUConstant(c, &sim);
+    FUOutput(x, &sim); FUOutput(slow, &sim); FUOutput(sunk, &sim);
+    sim.connectU(c, i); sim.connectU(i, x); sim.connectU(i, slow); sim.connectU(i, sunk);
+    slow->Set_SampleTime(0.1);
+    sunk->Set_Sink(std::make_shared<MemorySink>());
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    CHECK(sim.Save_Trace(name) == 0);
+
+    {
+        TraceReader reader(name);
+        CHECK(reader.Is_Open());
+        CHECK(reader.Get_Count() == 2);
+        CHECK(reader.Get_Name(0) == "x");
+        CHECK(reader.Get_Name(1) == "slow");
+        CHECK(reader.Find("sunk") == -1);
+        CHECK(reader.Get_SampleTime(1) == 0.1);
+        CHECK(Same(reader.Get_Signal(0), x->Get_StoredData()));
+        CHECK(Same(reader.Get_Signal("slow"), slow->Get_StoredData()));
+        CHECK(reader.Get_Signal(2).size == 0);
+        TraceView t = reader.Get_Time();
+        CHECK(t.size == x->Get_StoredData().size());
+        CHECK((t[0] == 0) && (fabs(t[t.size-1] - 1) < 1e-9));
+    }
+
+    std::vector<char> bytes = ReadBytes(name), bad;
+    TraceHead head;
+    memcpy(&head, bytes.data(), sizeof(head));
+    // Truncated inside the header, the columns, or the data.
+    for (size_t size: {(size_t)0, sizeof(TraceHead)-1, sizeof(TraceHead)+sizeof(TraceColumn), bytes.size()-8}) {
+        bad.assign(bytes.begin(), bytes.begin()+size);
+        CHECK(Rejected(bad));
+    }
+    // Wrong magic or version, no columns, or too many columns.
+    for (int field=0; field<4; ++field) {
+        TraceHead h = head;
+        if (field == 0) h.magic ^= 1;
+        if (field == 1) h.version++;
+        if (field == 2) h.columns = 0;
+        if (field == 3) h.columns = 0xFFFFFFFF;
+        bad = bytes;
+        memcpy(bad.data(), &h, sizeof(h));
+        CHECK(Rejected(bad));
+    }
+    // A column whose name or data are beyond the end, or isn't aligned.
+    for (int field=0; field<3; ++field) {
+        TraceColumn col;
+        memcpy(&col, bytes.data()+sizeof(TraceHead), sizeof(col));
+        if (field == 0) col.namelen = bytes.size();
+        if (field == 1) col.length = (uint64_t)1 << 62;
+        if (field == 2) col.offset += 4;
+        bad = bytes;
+        memcpy(bad.data()+sizeof(TraceHead), &col, sizeof(col));
+        CHECK(Rejected(bad));
+    }
+    // The bytes written by "Save_Trace()" are still accepted.
+    CHECK(!Rejected(bytes));
+    TraceReader missing("trace_missing.bin");
+    CHECK(!missing.Is_Open());
+    remove(name);
+    return failed;
+}
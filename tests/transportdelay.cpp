@@ -0,0 +1,71 @@
+/**********************
+Tests of TRANSPORTDELAY modules, which shift their inputs by whole steps
+ exactly and interpolate delays between steps.
+**********************/
+#include <cmath>
+#include <algorithm>
+#include "simucpp.hpp"
+#include "check.hpp"
+using namespace simucpp;
+
+// Stored data of an input "f" and of it delayed by "delay" seconds, with
+//  steps of 10 ms and the initial value -1.
+void Run(double (*f)(double), double delay, int interp, std::vector<double> &u, std::vector<double> &y) {
+    Simulator sim(1);
+    FUInput(in, &sim); FUTransportDelay(d, &sim); FUOutput(ou, &sim); FUOutput(oy, &sim);
+    in->Set_Function(f);
+    d->Set_DelayTime(delay); d->Set_Interpolation(interp); d->Set_InitialValue(-1);
+    sim.connectU(in, d); sim.connectU(in, ou); sim.connectU(d, oy);
+    sim.Set_SimStep(0.01);
+    sim.Initialize();
+    CHECK(sim.Simulate() == 0);
+    u = ou->Get_StoredData();
+    y = oy->Get_StoredData();
+    CHECK((u.size() == 101) && (y.size() == u.size()));
+}
+
+// A delay of N steps gives the input N samples ago in every mode, and the
+//  initial value until an input is stored after N steps.
+void Shift() {
+    std::vector<double> u, y;
+    for (int interp: {INTERP_NEAREST, INTERP_LINEAR, INTERP_LAGRANGE}) {
+        for (int n: {1, 3, 7}) {
+            Run([](double t){ return sin(10*t); }, 0.01*n, interp, u, y);
+            bool exact = true;
+            for (int i=0; i<(int)y.size(); ++i)
+                exact = exact && (y[i] == (i>n ? u[i-n] : -1));
+            CHECK(exact);
+        }
+    }
+}
+
+// A delay of 2.5 steps is exact for inputs each mode can represent.
+void Interpolate() {
+    std::vector<double> u, y;
+    double e;
+    // The nearest value is 3 steps ago.
+    Run([](double t){ return sin(10*t); }, 0.025, INTERP_NEAREST, u, y);
+    bool exact = true;
+    for (uint i=4; i<y.size(); ++i) exact = exact && (y[i] == u[i-3]);
+    CHECK(exact);
+    // Linear interpolation is exact for a ramp.
+    Run([](double t){ return 1+2*t; }, 0.025, INTERP_LINEAR, u, y);
+    e = 0;
+    for (uint i=4; i<y.size(); ++i) e = std::max(e, fabs(y[i] - (1+2*(0.01*i-0.025))));
+    CHECK(e < 1e-12);
+    // Cubic Lagrange interpolation is exact for a cubic, and linear one isn't.
+    Run([](double t){ return 1+t*t*t; }, 0.025, INTERP_LAGRANGE, u, y);
+    e = 0;
+    for (uint i=5; i<y.size(); ++i) e = std::max(e, fabs(y[i] - (1+pow(0.01*i-0.025, 3))));
+    CHECK(e < 1e-12);
+    Run([](double t){ return 1+t*t*t; }, 0.025, INTERP_LINEAR, u, y);
+    e = 0;
+    for (uint i=5; i<y.size(); ++i) e = std::max(e, fabs(y[i] - (1+pow(0.01*i-0.025, 3))));
+    CHECK(e > 1e-6);
+}
+
+int main() {
+    Shift();
+    Interpolate();
+    return failed;
+}